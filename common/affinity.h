@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// Розміщення потоків по ядрах і вузлах NUMA.
+// Сторінка пам'яті фізично виділяється на вузлі потоку, який першим у неї пише (first touch),
+// тому потік, закріплений за ядром, має сам ініціалізувати свою частину масиву
+
+enum class PinPolicy {
+    None,    // потоки не закріплюються, розміщенням керує ОС
+    Compact, // спершу всі ядра вузла 0, потім вузла 1 і так далі
+    Scatter  // потоки по черзі розкладаються між вузлами, щоб задіяти пропускну здатність усіх
+};
+
+inline const char* pinPolicyName(PinPolicy policy) {
+    switch (policy) {
+        case PinPolicy::Compact: return "compact";
+        case PinPolicy::Scatter: return "scatter";
+        default: return "none";
+    }
+}
+
+inline bool parsePinPolicy(const std::string& name, PinPolicy& policy) {
+    if (name == "none") policy = PinPolicy::None;
+    else if (name == "compact") policy = PinPolicy::Compact;
+    else if (name == "scatter") policy = PinPolicy::Scatter;
+    else return false;
+    return true;
+}
+
+// Формат cpulist ядра Linux: "0-3,8,10-11"
+inline std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        size_t dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// Логічні процесори, згруповані за вузлами NUMA. Лише ті, на яких процесу дозволено працювати
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes;
+
+    int nodeCount() const { return int(nodes.size()); }
+
+    int cpuCount() const {
+        int count = 0;
+        for (const auto& node : nodes) count += int(node.size());
+        return count;
+    }
+
+    int nodeOfCpu(int cpu) const {
+        for (int node = 0; node < nodeCount(); node++) {
+            if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end()) return node;
+        }
+        return -1;
+    }
+};
+
+inline CpuTopology detectTopology() {
+    CpuTopology topology;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAllowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto isAllowed = [&](int cpu) { return !haveAllowed || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)); };
+
+    std::vector<int> nodeIds;
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.rfind("node", 0) == 0 && name.size() > 4 && std::isdigit((unsigned char)name[4])) {
+                nodeIds.push_back(std::stoi(name.substr(4)));
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(nodeIds.begin(), nodeIds.end());
+    for (int id : nodeIds) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string text;
+        std::getline(file, text);
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(text)) {
+            if (isAllowed(cpu)) cpus.push_back(cpu);
+        }
+        if (!cpus.empty()) topology.nodes.push_back(cpus);
+    }
+    if (topology.nodes.empty() && haveAllowed) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+        if (!cpus.empty()) topology.nodes.push_back(cpus);
+    }
+#elif defined(_WIN32)
+    ULONG highestNode = 0;
+    if (GetNumaHighestNodeNumber(&highestNode)) {
+        for (ULONG node = 0; node <= highestNode; node++) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(UCHAR(node), &mask) || mask == 0) continue;
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < 64; cpu++) {
+                if (mask & (1ULL << cpu)) cpus.push_back(cpu);
+            }
+            topology.nodes.push_back(cpus);
+        }
+    }
+#endif
+    // Невідома платформа або помилка: один вузол з усіма ядрами
+    if (topology.nodes.empty()) {
+        std::vector<int> cpus;
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; cpu++) cpus.push_back(cpu);
+        topology.nodes.push_back(cpus);
+    }
+    return topology;
+}
+
+inline const CpuTopology& cpuTopology() {
+    static const CpuTopology topology = detectTopology();
+    return topology;
+}
+
+// Ядро для потоку thread за політикою; -1, якщо закріплювати не треба.
+// Потоків більше, ніж ядер, - нумерація йде по колу
+inline int cpuForThread(PinPolicy policy, int thread, const CpuTopology& topology = cpuTopology()) {
+    if (policy == PinPolicy::None) return -1;
+    int slot = thread % topology.cpuCount();
+    if (policy == PinPolicy::Compact) {
+        for (const auto& node : topology.nodes) {
+            if (slot < int(node.size())) return node[slot];
+            slot -= int(node.size());
+        }
+        return -1;
+    }
+    // Scatter: вузли по колу; якщо у вузлі ядра скінчилися, він пропускається
+    std::vector<size_t> used(topology.nodes.size(), 0);
+    for (int taken = 0;;) {
+        for (size_t node = 0; node < topology.nodes.size(); node++) {
+            if (used[node] == topology.nodes[node].size()) continue;
+            if (taken++ == slot) return topology.nodes[node][used[node]];
+            used[node]++;
+        }
+    }
+}
+
+inline bool pinCurrentThreadToCpu(int cpu) {
+    if (cpu < 0) return false;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    if (cpu >= 64) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    return false;
+#endif
+}
+
+// Закріплює поточний потік як потік номер thread; помилка (наприклад, ядро заборонене) не критична
+inline bool pinCurrentThread(PinPolicy policy, int thread) {
+    return pinCurrentThreadToCpu(cpuForThread(policy, thread));
+}
+
+// Алокатор без value-ініціалізації: vector<int, FirstTouchAllocator<int>>(n) не записує нулі
+// в головному потоці, тож сторінки потраплять на вузол того потоку, що заповнить їх першим
+template <typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        using other = FirstTouchAllocator<U>;
+    };
+
+    FirstTouchAllocator() = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>&) noexcept {}
+
+    template <typename U>
+    void construct(U* ptr) noexcept {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
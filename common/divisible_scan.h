@@ -0,0 +1,179 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DIVISIBLE_SCAN_X86 1
+#endif
+
+// Підрахунок елементів, кратних DIVISOR, і мінімального з них.
+// Для непарного дільника d ділення замінено множенням на обернений за модулем 2^32:
+// x = d*q тоді й лише тоді, коли x * inv(d) = q, а |q| <= L = (2^31 - 1) / d,
+// тобто перевірка зводиться до (uint32)(x * inv + L) <= 2L без розгалужень
+template <int DIVISOR>
+struct DivisibilityTest {
+    static_assert(DIVISOR > 0, "divisor must be positive");
+
+    static constexpr bool fast = DIVISOR % 2 == 1 && DIVISOR > 1;
+
+    static constexpr uint32_t inverse() {
+        uint32_t inv = uint32_t(DIVISOR);
+        for (int i = 0; i < 5; i++) {
+            inv *= 2 - uint32_t(DIVISOR) * inv;
+        }
+        return inv;
+    }
+
+    static constexpr uint32_t inv = inverse();
+    static constexpr uint32_t bias = uint32_t(INT_MAX) / uint32_t(DIVISOR);
+    static constexpr uint32_t limit = 2 * bias;
+
+    static bool check(int x) {
+        if constexpr (fast) {
+            return uint32_t(x) * inv + bias <= limit;
+        } else {
+            return x % DIVISOR == 0;
+        }
+    }
+};
+
+struct DivisibleScanResult {
+    long long count = 0;
+    int min_element = INT_MAX; // має сенс лише при count > 0
+};
+
+template <int DIVISOR>
+void scanDivisibleScalar(const int* data, size_t n, DivisibleScanResult& result) {
+    for (size_t i = 0; i < n; i++) {
+        int x = data[i];
+        bool hit = DivisibilityTest<DIVISOR>::check(x);
+        result.count += hit;
+        int candidate = hit ? x : INT_MAX;
+        result.min_element = candidate < result.min_element ? candidate : result.min_element;
+    }
+}
+
+#ifdef DIVISIBLE_SCAN_X86
+// Лічильники в лініях 32-бітні, тому векторні ядра йдуть блоками і скидають їх у 64-бітну суму
+const size_t SCAN_BLOCK = size_t(1) << 28;
+
+template <int DIVISOR>
+__attribute__((target("sse4.1")))
+size_t scanDivisibleSse41(const int* data, size_t n, DivisibleScanResult& result) {
+    using Test = DivisibilityTest<DIVISOR>;
+    static_assert(Test::fast, "vector kernels need an odd divisor greater than 1");
+    const __m128i inv = _mm_set1_epi32(int(Test::inv));
+    const __m128i bias = _mm_set1_epi32(int(Test::bias));
+    const __m128i limit = _mm_set1_epi32(int(Test::limit));
+    __m128i vmin = _mm_set1_epi32(result.min_element);
+
+    size_t i = 0;
+    while (i + 4 <= n) {
+        size_t blockEnd = (n - i > SCAN_BLOCK) ? i + SCAN_BLOCK : n;
+        __m128i vcount = _mm_setzero_si128();
+        for (; i + 4 <= blockEnd; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i t = _mm_add_epi32(_mm_mullo_epi32(x, inv), bias);
+            __m128i hit = _mm_cmpeq_epi32(_mm_min_epu32(t, limit), t);
+            vcount = _mm_sub_epi32(vcount, hit);
+            vmin = _mm_min_epi32(vmin, _mm_blendv_epi8(vmin, x, hit));
+        }
+        alignas(16) uint32_t counts[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(counts), vcount);
+        for (uint32_t c : counts) result.count += c;
+    }
+
+    alignas(16) int mins[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    for (int m : mins) result.min_element = m < result.min_element ? m : result.min_element;
+    return i;
+}
+
+template <int DIVISOR>
+__attribute__((target("avx2")))
+size_t scanDivisibleAvx2(const int* data, size_t n, DivisibleScanResult& result) {
+    using Test = DivisibilityTest<DIVISOR>;
+    static_assert(Test::fast, "vector kernels need an odd divisor greater than 1");
+    const __m256i inv = _mm256_set1_epi32(int(Test::inv));
+    const __m256i bias = _mm256_set1_epi32(int(Test::bias));
+    const __m256i limit = _mm256_set1_epi32(int(Test::limit));
+    __m256i vmin = _mm256_set1_epi32(result.min_element);
+
+    size_t i = 0;
+    while (i + 8 <= n) {
+        size_t blockEnd = (n - i > SCAN_BLOCK) ? i + SCAN_BLOCK : n;
+        __m256i vcount = _mm256_setzero_si256();
+        for (; i + 8 <= blockEnd; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(x, inv), bias);
+            __m256i hit = _mm256_cmpeq_epi32(_mm256_min_epu32(t, limit), t);
+            vcount = _mm256_sub_epi32(vcount, hit);
+            vmin = _mm256_min_epi32(vmin, _mm256_blendv_epi8(vmin, x, hit));
+        }
+        alignas(32) uint32_t counts[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(counts), vcount);
+        for (uint32_t c : counts) result.count += c;
+    }
+
+    alignas(32) int mins[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), vmin);
+    for (int m : mins) result.min_element = m < result.min_element ? m : result.min_element;
+    return i;
+}
+
+template <int DIVISOR>
+__attribute__((target("avx512f")))
+size_t scanDivisibleAvx512(const int* data, size_t n, DivisibleScanResult& result) {
+    using Test = DivisibilityTest<DIVISOR>;
+    static_assert(Test::fast, "vector kernels need an odd divisor greater than 1");
+    const __m512i inv = _mm512_set1_epi32(int(Test::inv));
+    const __m512i bias = _mm512_set1_epi32(int(Test::bias));
+    const __m512i limit = _mm512_set1_epi32(int(Test::limit));
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i vmin = _mm512_set1_epi32(result.min_element);
+
+    size_t i = 0;
+    while (i + 16 <= n) {
+        size_t blockEnd = (n - i > SCAN_BLOCK) ? i + SCAN_BLOCK : n;
+        __m512i vcount = _mm512_setzero_si512();
+        for (; i + 16 <= blockEnd; i += 16) {
+            __m512i x = _mm512_loadu_si512(data + i);
+            __m512i t = _mm512_add_epi32(_mm512_mullo_epi32(x, inv), bias);
+            __mmask16 hit = _mm512_cmple_epu32_mask(t, limit);
+            vcount = _mm512_mask_add_epi32(vcount, hit, vcount, one);
+            vmin = _mm512_mask_min_epi32(vmin, hit, vmin, x);
+        }
+        alignas(64) uint32_t counts[16];
+        _mm512_store_si512(counts, vcount);
+        for (uint32_t c : counts) result.count += c;
+    }
+
+    alignas(64) int mins[16];
+    _mm512_store_si512(mins, vmin);
+    for (int m : mins) result.min_element = m < result.min_element ? m : result.min_element;
+    return i;
+}
+#endif
+
+// Вибір ядра під час виконання: AVX-512 -> AVX2 -> SSE4.1 -> скалярне.
+// Хвіст, що не заповнює вектор, завжди дораховується скалярно
+template <int DIVISOR>
+DivisibleScanResult scanDivisible(const int* data, size_t n) {
+    DivisibleScanResult result;
+    size_t done = 0;
+#ifdef DIVISIBLE_SCAN_X86
+    if constexpr (DivisibilityTest<DIVISOR>::fast) {
+        static const int level = __builtin_cpu_supports("avx512f") ? 3
+                               : __builtin_cpu_supports("avx2") ? 2
+                               : __builtin_cpu_supports("sse4.1") ? 1 : 0;
+        if (level == 3) done = scanDivisibleAvx512<DIVISOR>(data, n, result);
+        else if (level == 2) done = scanDivisibleAvx2<DIVISOR>(data, n, result);
+        else if (level == 1) done = scanDivisibleSse41<DIVISOR>(data, n, result);
+    }
+#endif
+    scanDivisibleScalar<DIVISOR>(data + done, n - done, result);
+    return result;
+}
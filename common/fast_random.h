@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FAST_RANDOM_X86 1
+#endif
+
+// Лічильниковий генератор: значення залежить лише від (seed, index), тому потоки
+// не мають спільного стану і результат не залежить від поділу масиву між ними
+inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t randomKey(uint64_t seed, uint64_t index) {
+    return mix32(uint32_t(seed) ^ mix32(uint32_t(seed >> 32) ^ uint32_t(index >> 32)));
+}
+
+inline uint32_t counterRandom(uint64_t seed, uint64_t index) {
+    uint32_t key = randomKey(seed, index);
+    return mix32(mix32(uint32_t(index) ^ key) + key);
+}
+
+// Рівномірне число з [0, range) без зміщення: множення Леміра з відкиданням
+// (повторна спроба бере значення з іншого потоку генератора, тож лишається детермінованою)
+inline uint32_t boundedRandom(uint64_t seed, uint64_t index, uint32_t range) {
+    uint64_t product = uint64_t(counterRandom(seed, index)) * range;
+    if (uint32_t(product) < range) {
+        uint32_t threshold = uint32_t(-range) % range;
+        for (uint64_t attempt = 1; uint32_t(product) < threshold; attempt++) {
+            product = uint64_t(counterRandom(seed + attempt * 0x9e3779b97f4a7c15ULL, index)) * range;
+        }
+    }
+    return uint32_t(product >> 32);
+}
+
+// out[k] - рівномірне число з [minValue, maxValue] для індексу firstIndex + k
+inline void fillBoundedRandomScalar(int* out, size_t count, uint64_t seed, uint64_t firstIndex,
+                                    int minValue, int maxValue) {
+    uint32_t range = uint32_t(maxValue) - uint32_t(minValue) + 1;
+    for (size_t k = 0; k < count; k++) {
+        uint32_t value = range == 0 ? counterRandom(seed, firstIndex + k)
+                                    : boundedRandom(seed, firstIndex + k, range);
+        out[k] = int(uint32_t(minValue) + value);
+    }
+}
+
+#ifdef FAST_RANDOM_X86
+__attribute__((target("avx2")))
+inline __m256i mix32x8(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(int(0x7feb352dU)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(int(0x846ca68bU)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+// Вісім значень за ітерацію. Рідкісні відкинуті лінії (молодша половина добутку
+// менша за range) перераховуються скалярно, тож результат збігається зі скалярним
+__attribute__((target("avx2")))
+inline void fillBoundedRandomAvx2(int* out, size_t count, uint64_t seed, uint64_t firstIndex,
+                                  int minValue, int maxValue) {
+    uint32_t range = uint32_t(maxValue) - uint32_t(minValue) + 1;
+    if (range == 0) {
+        fillBoundedRandomScalar(out, count, seed, firstIndex, minValue, maxValue);
+        return;
+    }
+
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i rangeVec = _mm256_set1_epi32(int(range));
+    const __m256i rangeMinusOne = _mm256_set1_epi32(int(range - 1));
+    const __m256i offset = _mm256_set1_epi32(minValue);
+
+    size_t k = 0;
+    while (k < count) {
+        // Ключ залежить від старших 32 бітів індексу, тож ділимо пакет на межах 2^32
+        uint64_t index = firstIndex + k;
+        uint64_t blockLeft = (uint64_t(1) << 32) - uint32_t(index);
+        size_t blockEnd = count - k > blockLeft ? k + size_t(blockLeft) : count;
+        __m256i key = _mm256_set1_epi32(int(randomKey(seed, index)));
+
+        for (; k + 8 <= blockEnd; k += 8) {
+            __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(int(uint32_t(firstIndex + k))), lanes);
+            __m256i x = mix32x8(_mm256_add_epi32(mix32x8(_mm256_xor_si256(idx, key)), key));
+
+            __m256i evenProduct = _mm256_mul_epu32(x, rangeVec);
+            __m256i oddProduct = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), rangeVec);
+            __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(evenProduct, 32), oddProduct, 0xAA);
+            __m256i low = _mm256_blend_epi32(evenProduct, _mm256_slli_epi64(oddProduct, 32), 0xAA);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_add_epi32(high, offset));
+
+            __m256i suspicious = _mm256_cmpeq_epi32(_mm256_min_epu32(low, rangeMinusOne), low);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(suspicious));
+            while (mask) {
+                int lane = __builtin_ctz(mask);
+                mask &= mask - 1;
+                out[k + lane] = int(uint32_t(minValue) + boundedRandom(seed, firstIndex + k + lane, range));
+            }
+        }
+        if (blockEnd - k < 8) {
+            fillBoundedRandomScalar(out + k, blockEnd - k, seed, firstIndex + k, minValue, maxValue);
+            k = blockEnd;
+        }
+    }
+}
+#endif
+
+// Пакетне заповнення: AVX2, якщо процесор його підтримує, інакше скалярний шлях.
+// Обидва шляхи дають однакові числа для однакових (seed, index)
+inline void fillBoundedRandom(int* out, size_t count, uint64_t seed, uint64_t firstIndex,
+                              int minValue, int maxValue) {
+#ifdef FAST_RANDOM_X86
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (hasAvx2) {
+        fillBoundedRandomAvx2(out, count, seed, firstIndex, minValue, maxValue);
+        return;
+    }
+#endif
+    fillBoundedRandomScalar(out, count, seed, firstIndex, minValue, maxValue);
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "divisible_scan.h"
+
+// Узагальнений прохід "фільтр + згортка": предикат і набір агрегатів задаються
+// параметрами шаблону, тому кожна комбінація інлайниться в один цикл без викликів через вказівник
+
+// Предикати
+template <int DIVISOR>
+struct DivisibleBy {
+    bool operator()(int value) const { return DivisibilityTest<DIVISOR>::check(value); }
+};
+
+struct InRange {
+    int low;
+    int high;
+    bool operator()(int value) const { return low <= value && value <= high; }
+};
+
+// Агрегати: add викликається для кожного елемента, що пройшов фільтр,
+// merge поєднує часткові результати сусідніх фрагментів (лівий з правим)
+struct CountAggregate {
+    long long count = 0;
+
+    void add(int, size_t) { count++; }
+    void merge(const CountAggregate& other) { count += other.count; }
+};
+
+struct MinAggregate {
+    bool has_min = false;
+    int min_element = -1; // -1, якщо жоден елемент не пройшов фільтр
+
+    void add(int value, size_t) {
+        min_element = (has_min && min_element < value) ? min_element : value;
+        has_min = true;
+    }
+    void merge(const MinAggregate& other) {
+        if (other.has_min) add(other.min_element, 0);
+    }
+};
+
+struct MaxAggregate {
+    bool has_max = false;
+    int max_element = -1; // -1, якщо жоден елемент не пройшов фільтр
+
+    void add(int value, size_t) {
+        max_element = (has_max && max_element > value) ? max_element : value;
+        has_max = true;
+    }
+    void merge(const MaxAggregate& other) {
+        if (other.has_max) add(other.max_element, 0);
+    }
+};
+
+struct SumAggregate {
+    long long sum = 0;
+
+    void add(int value, size_t) { sum += value; }
+    void merge(const SumAggregate& other) { sum += other.sum; }
+};
+
+struct FirstIndexAggregate {
+    long long first_index = -1;
+
+    void add(int, size_t index) {
+        if (first_index < 0) first_index = (long long)index;
+    }
+    void merge(const FirstIndexAggregate& other) {
+        if (first_index < 0) first_index = other.first_index;
+    }
+};
+
+template <typename... Aggregates>
+struct FilterReduceResult : Aggregates... {
+    void add(int value, size_t index) { (Aggregates::add(value, index), ...); }
+    void merge(const FilterReduceResult& other) { (Aggregates::merge(other), ...); }
+};
+
+inline int loadValue(int value) { return value; }
+inline int loadValue(const std::atomic<int>& value) { return value.load(std::memory_order_relaxed); }
+
+template <typename Predicate>
+struct DivisorOf { static constexpr int value = 0; };
+
+template <int DIVISOR>
+struct DivisorOf<DivisibleBy<DIVISOR>> { static constexpr int value = DIVISOR; };
+
+// Прохід по data[begin, end) з дописуванням у result; індекси в агрегатах - глобальні.
+// Агрегати починають з того стану, що вже є в result (так агрегат може нести посилання на спільний підсумок).
+// Комбінація "кратні D + кількість + мінімум" іде через векторне ядро scanDivisible
+template <typename Predicate, typename... Aggregates, typename T>
+void filterReduceInto(FilterReduceResult<Aggregates...>& result, const T* data, size_t begin, size_t end,
+                      Predicate predicate = Predicate()) {
+    using Result = FilterReduceResult<Aggregates...>;
+
+    constexpr int divisor = DivisorOf<Predicate>::value;
+    if constexpr (divisor > 0 && std::is_same_v<T, int> &&
+                  std::is_same_v<Result, FilterReduceResult<CountAggregate, MinAggregate>>) {
+        DivisibleScanResult scan = scanDivisible<divisor>(data + begin, end - begin);
+        Result block;
+        block.count = scan.count;
+        block.has_min = scan.count > 0;
+        block.min_element = scan.count > 0 ? scan.min_element : -1;
+        result.merge(block);
+    } else {
+        for (size_t i = begin; i < end; i++) {
+            int value = loadValue(data[i]);
+            if (predicate(value)) result.add(value, i);
+        }
+    }
+}
+
+template <typename Predicate, typename... Aggregates, typename T>
+FilterReduceResult<Aggregates...> filterReduce(const T* data, size_t begin, size_t end,
+                                               Predicate predicate = Predicate()) {
+    FilterReduceResult<Aggregates...> result;
+    filterReduceInto<Predicate>(result, data, begin, end, predicate);
+    return result;
+}
+
+// Паралельний варіант: масив ділиться на numThreads суцільних фрагментів,
+// кожен потік рахує власний частковий результат, після join вони зливаються по порядку
+template <typename Predicate, typename... Aggregates>
+FilterReduceResult<Aggregates...> parallelFilterReduce(const std::vector<int>& numbers, int numThreads,
+                                                       Predicate predicate = Predicate()) {
+    using Result = FilterReduceResult<Aggregates...>;
+    std::vector<Result> partial(numThreads);
+    std::vector<std::thread> threads;
+
+    size_t chunkSize = numbers.size() / numThreads;
+    size_t remainder = numbers.size() % numThreads;
+    size_t startIdx = 0;
+    for (int t = 0; t < numThreads; ++t) {
+        size_t endIdx = startIdx + chunkSize + (size_t(t) < remainder ? 1 : 0);
+        threads.emplace_back([&, t, startIdx, endIdx] {
+            partial[t] = filterReduce<Predicate, Aggregates...>(numbers.data(), startIdx, endIdx, predicate);
+        });
+        startIdx = endIdx;
+    }
+    for (auto& t : threads) t.join();
+
+    Result result;
+    for (const Result& part : partial) result.merge(part);
+    return result;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <mutex>
+#include "filter_reduce.h"
+
+// Способи, якими варіанти lab2 зводять "кількість + мінімум" кратних DIVISOR з кількох потоків
+// в один підсумок. Ці самі функції запускають і лабораторні, і lab2_bench, тож бенчмарк міряє
+// саме той код, що працює в лабах
+
+// lab2_2: потік рахує свій фрагмент локально, а готовий підсумок зливає в спільний під м'ютексом
+struct LockedCountMin {
+    std::mutex mtx;
+    long long count = 0;
+    int min_element = -1; // -1, якщо кратних немає
+
+    void merge(long long localCount, int localMin) {
+        std::lock_guard<std::mutex> lock(mtx);
+        count += localCount;
+        if (localMin != -1 && (min_element == -1 || localMin < min_element)) {
+            min_element = localMin;
+        }
+    }
+};
+
+template <int DIVISOR, typename T>
+void scanChunkLocked(const T* data, size_t begin, size_t end, LockedCountMin& total) {
+    auto local = filterReduce<DivisibleBy<DIVISOR>, CountAggregate, MinAggregate>(data, begin, end);
+    total.merge(local.count, local.min_element);
+}
+
+// lab2_3 (спільні атомарні лічильники): кожне знайдене значення одразу публікується
+// через fetch_add і CAS, без локального підсумку
+struct AtomicCountMin {
+    std::atomic<long long> count{0};
+    std::atomic<int> min_element{INT_MAX}; // INT_MAX, поки кратних немає
+
+    void add(int value) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        int current_min = min_element.load(std::memory_order_relaxed);
+        while (value < current_min &&
+               !min_element.compare_exchange_weak(current_min, value, std::memory_order_relaxed));
+    }
+};
+
+// Агрегат filter/reduce, що пише в AtomicCountMin; ціль задається до проходу через filterReduceInto
+struct SharedAtomicCountMin {
+    AtomicCountMin* target = nullptr;
+
+    void add(int value, size_t) { target->add(value); }
+    void merge(const SharedAtomicCountMin&) {}
+};
+
+template <int DIVISOR, typename T>
+void scanChunkAtomic(const T* data, size_t begin, size_t end, AtomicCountMin& total) {
+    FilterReduceResult<SharedAtomicCountMin> shared;
+    shared.target = &total;
+    filterReduceInto<DivisibleBy<DIVISOR>>(shared, data, begin, end);
+}
+
+// lab2_3 (часткові результати): підсумок кожного потоку займає власну кеш-лінію, тож потоки
+// не штовхають одну лінію між ядрами; злиття - один раз, після завершення всіх потоків
+struct alignas(64) PaddedCountMin {
+    FilterReduceResult<CountAggregate, MinAggregate> result;
+};
+
+template <int DIVISOR, typename T>
+void scanChunkPartial(const T* data, size_t begin, size_t end, PaddedCountMin& partial) {
+    partial.result = filterReduce<DivisibleBy<DIVISOR>, CountAggregate, MinAggregate>(data, begin, end);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Дзеркалення квадратної матриці size x size (рядки підряд) відносно побічної діагоналі на місці.
+// Якщо рахувати стовпці з кінця (c = size-1-j), дзеркалення стає звичайним транспонуванням:
+// тайл (R, C) міняється місцями з тайлом (C, R), тож достатньо пройти пари тайлів R <= C
+
+inline void swapTilePair(int* matrix, int size, int R, int C, int tile) {
+    int rEnd = std::min((R + 1) * tile, size);
+    int cEnd = std::min((C + 1) * tile, size);
+    for (int r = R * tile; r < rEnd; r++) {
+        int* row = matrix + size_t(r) * size;
+        int cStart = (R == C) ? r + 1 : C * tile;
+        for (int c = cStart; c < cEnd; c++) {
+            std::swap(row[size - 1 - c], matrix[size_t(c) * size + size - 1 - r]);
+        }
+    }
+}
+
+// Діагональна пара тайлів важить 1, недіагональна - 2, тож сумарна вага дорівнює tiles^2
+inline long long tileWeight(int size, int tile) {
+    if (size <= 0) return 0;
+    long long tiles = (size + tile - 1) / tile;
+    return tiles * tiles;
+}
+
+// Пари з початковою вагою в [firstWeight, lastWeight), тож рівні частини tileWeight дають потокам рівну роботу.
+// Рядок тайлів, що цілком лежить до firstWeight, пропускається без обходу його пар
+inline void mirrorTilePairs(int* matrix, int size, long long firstWeight, long long lastWeight, int tile) {
+    int tiles = size <= 0 ? 0 : (size + tile - 1) / tile;
+    long long weight = 0;
+    for (int R = 0; R < tiles && weight < lastWeight; R++) {
+        long long rowWeight = 1 + 2LL * (tiles - R - 1);
+        if (weight + rowWeight <= firstWeight) {
+            weight += rowWeight;
+            continue;
+        }
+        for (int C = R; C < tiles && weight < lastWeight; C++) {
+            if (weight >= firstWeight) swapTilePair(matrix, size, R, C, tile);
+            weight += (R == C) ? 1 : 2;
+        }
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#endif
+
+// Кадри TLV протоколу lab4: 1 байт типу, 4 байти довжини (порядок байтів хоста), далі дані.
+// Заголовок і дані відправляються одним векторним записом, а прийом іде через буфер з'єднання:
+// один recv може принести кілька кадрів або лише шматок заголовка
+
+#ifdef _WIN32
+using TLVSocket = SOCKET;
+#else
+using TLVSocket = int;
+#endif
+
+const size_t TLV_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+const size_t TLV_READ_CHUNK = 64 * 1024;
+
+inline void encodeTLVHeader(char* header, uint8_t type, uint32_t length) {
+    header[0] = char(type);
+    memcpy(header + 1, &length, sizeof(length));
+}
+
+inline void decodeTLVHeader(const char* header, uint8_t& type, uint32_t& length) {
+    type = uint8_t(header[0]);
+    memcpy(&length, header + 1, sizeof(length));
+}
+
+inline void appendTLVHeader(std::vector<char>& out, uint8_t type, uint32_t length) {
+    size_t offset = out.size();
+    out.resize(offset + TLV_HEADER_SIZE);
+    encodeTLVHeader(out.data() + offset, type, length);
+}
+
+// Для неблокуючих сокетів: кадр дописується в чергу відправлення з'єднання
+inline void appendTLV(std::vector<char>& out, uint8_t type, const void* data, uint32_t length) {
+    appendTLVHeader(out, type, length);
+    out.insert(out.end(), static_cast<const char*>(data), static_cast<const char*>(data) + length);
+}
+
+// Префікс кадру з блоком рядків матриці: перший рядок (64 біти - у потоковому режимі матриця
+// може бути більшою за 4 ГБ) і кількість рядків; далі самі рядки
+const size_t ROW_CHUNK_PREFIX = sizeof(uint64_t) + sizeof(uint32_t);
+
+inline void encodeRowChunk(char* prefix, uint64_t firstRow, uint32_t rowCount) {
+    memcpy(prefix, &firstRow, sizeof(firstRow));
+    memcpy(prefix + sizeof(firstRow), &rowCount, sizeof(rowCount));
+}
+
+inline void decodeRowChunk(const char* prefix, uint64_t& firstRow, uint32_t& rowCount) {
+    memcpy(&firstRow, prefix, sizeof(firstRow));
+    memcpy(&rowCount, prefix + sizeof(firstRow), sizeof(rowCount));
+}
+
+// Кадр, що лежить у буфері TLVReader; value дійсне до наступного writePtr
+struct TLVFrame {
+    uint8_t type = 0;
+    uint32_t length = 0;
+    const char* value = nullptr;
+};
+
+// Буфер прийому одного з'єднання. recv пише у writePtr(), commit позначає прийняті байти,
+// next віддає кадри, поки в буфері є повні. Кадр довший за maxFrame next не віддає і місця
+// під нього не виділяє: сервер не довіряє довжині із заголовка клієнта
+class TLVReader {
+public:
+    explicit TLVReader(size_t chunk = TLV_READ_CHUNK, uint32_t maxFrame = std::numeric_limits<uint32_t>::max())
+        : chunk(chunk), maxFrame(maxFrame) {}
+
+    // Місце щонайменше на chunk байтів (або на решту поточного кадру, якщо вона більша).
+    // Розібрані байти зсуваються на початок лише тут, тож кадри, віддані next, досі дійсні до цього виклику
+    char* writePtr() {
+        if (start > 0) {
+            memmove(buffer.data(), buffer.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        size_t wanted = std::max(chunk, pending);
+        if (buffer.size() < end + wanted) buffer.resize(end + wanted);
+        return buffer.data() + end;
+    }
+
+    size_t writable() const { return buffer.size() - end; }
+
+    void commit(size_t count) { end += count; }
+
+    size_t buffered() const { return end - start; }
+
+    const char* data() const { return buffer.data() + start; }
+
+    void consume(size_t count) { start += std::min(count, buffered()); }
+
+    // Заголовок наступного кадру, навіть якщо його дані ще не прийшли
+    bool peekHeader(uint8_t& type, uint32_t& length) const {
+        if (buffered() < TLV_HEADER_SIZE) return false;
+        decodeTLVHeader(data(), type, length);
+        return true;
+    }
+
+    // Заголовок наступного кадру вже прийшов і його довжина більша за maxFrame
+    bool oversized() const {
+        uint8_t type;
+        uint32_t length;
+        return peekHeader(type, length) && length > maxFrame;
+    }
+
+    bool next(TLVFrame& frame) {
+        if (!peekHeader(frame.type, frame.length) || frame.length > maxFrame) return false;
+        if (buffered() < TLV_HEADER_SIZE + frame.length) {
+            // Наступний writePtr виділить місце одразу на весь кадр, а не по chunk
+            pending = TLV_HEADER_SIZE + frame.length - buffered();
+            return false;
+        }
+        frame.value = data() + TLV_HEADER_SIZE;
+        start += TLV_HEADER_SIZE + frame.length;
+        pending = 0;
+        if (start == end) start = end = 0;
+        return true;
+    }
+
+private:
+    std::vector<char> buffer;
+    size_t start = 0;
+    size_t end = 0;
+    size_t pending = 0;
+    size_t chunk;
+    uint32_t maxFrame;
+};
+
+struct TLVChunk {
+    const char* data;
+    size_t size;
+};
+
+#ifdef _WIN32
+inline long long sendChunks(TLVSocket socket, const TLVChunk* chunks, int count) {
+    WSABUF buffers[8];
+    count = std::min(count, 8);
+    for (int i = 0; i < count; ++i) {
+        buffers[i].buf = const_cast<char*>(chunks[i].data);
+        buffers[i].len = ULONG(std::min<size_t>(chunks[i].size, 1u << 30));
+    }
+    DWORD sent = 0;
+    if (WSASend(socket, buffers, DWORD(count), &sent, 0, nullptr, nullptr) != 0) return -1;
+    return sent;
+}
+#else
+inline long long sendChunks(TLVSocket socket, const TLVChunk* chunks, int count) {
+    iovec parts[8];
+    count = std::min(count, 8);
+    for (int i = 0; i < count; ++i) {
+        parts[i].iov_base = const_cast<char*>(chunks[i].data);
+        parts[i].iov_len = chunks[i].size;
+    }
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = count;
+    while (true) {
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent >= 0 || errno != EINTR) return sent;
+    }
+}
+#endif
+
+// Блокуючий векторний запис: повторює виклик з рештою частин, якщо сокет прийняв не все
+inline bool sendAll(TLVSocket socket, TLVChunk* chunks, int count) {
+    while (count > 0) {
+        if (chunks->size == 0) {
+            chunks++;
+            count--;
+            continue;
+        }
+        long long sent = sendChunks(socket, chunks, count);
+        if (sent <= 0) return false;
+        while (sent > 0) {
+            size_t step = std::min<size_t>(size_t(sent), chunks->size);
+            chunks->data += step;
+            chunks->size -= step;
+            sent -= step;
+            if (chunks->size == 0) {
+                chunks++;
+                count--;
+            }
+        }
+    }
+    return true;
+}
+
+// Заголовок і дані одним системним викликом
+inline bool sendTLV(TLVSocket socket, uint8_t type, const void* data, uint32_t length) {
+    char header[TLV_HEADER_SIZE];
+    encodeTLVHeader(header, type, length);
+    TLVChunk chunks[2] = {{header, TLV_HEADER_SIZE}, {static_cast<const char*>(data), length}};
+    return sendAll(socket, chunks, 2);
+}
+
+// Блокуючий прийом у буфер: false - з'єднання закрите або помилка
+inline bool receiveMore(TLVSocket socket, TLVReader& reader) {
+    char* target = reader.writePtr();
+    int received = recv(socket, target, int(std::min<size_t>(reader.writable(), 1u << 30)), 0);
+    if (received <= 0) return false;
+    reader.commit(size_t(received));
+    return true;
+}
+
+// false - з'єднання закрите, помилка або кадр довший за дозволений
+inline bool receiveTLV(TLVSocket socket, TLVReader& reader, TLVFrame& frame) {
+    while (!reader.next(frame)) {
+        if (reader.oversized() || !receiveMore(socket, reader)) return false;
+    }
+    return true;
+}
+
+inline bool receiveHeader(TLVSocket socket, TLVReader& reader, uint8_t& type, uint32_t& length) {
+    while (!reader.peekHeader(type, length)) {
+        if (!receiveMore(socket, reader)) return false;
+    }
+    return true;
+}
+
+// Дані кадру, заголовок якого вже взято через receiveHeader і consume, - прямо в target:
+// з буфера копіюється лише те, що прийшло разом із заголовком
+inline bool receivePayload(TLVSocket socket, TLVReader& reader, char* target, size_t length) {
+    size_t buffered = std::min(length, reader.buffered());
+    memcpy(target, reader.data(), buffered);
+    reader.consume(buffered);
+    for (size_t received = buffered; received < length;) {
+        int chunk = recv(socket, target + received, int(std::min<size_t>(length - received, 1u << 30)), 0);
+        if (chunk <= 0) return false;
+        received += size_t(chunk);
+    }
+    return true;
+}
@@ -3,12 +3,120 @@
 #include <ctime>
 #include <thread>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <barrier>
+#include <cstdint>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#include "../common/fast_random.h"
+#include "../common/affinity.h"
+#include "../common/tile_mirror.h"
 
 using namespace std;
+using namespace chrono;
 
 const int N = 100; // Розмір квадратної матриці
 const int M = 1000;
 const int THREADS = 6; // Кількість потоків
+const int TILE = 0; // Сторона тайла для дзеркалення (0 - визначити за розміром L1-кешу)
+const uint64_t SEED = 2024; // Базове зерно: однакове зерно дає однакову матрицю за будь-якої кількості потоків
+const PinPolicy PIN = PinPolicy::Scatter; // Закріплення потоків пулу за ядрами (None - на розсуд ОС)
+
+// Суцільна матриця з рядковим розміщенням: один блок пам'яті замість окремого new на кожен рядок
+// Пам'ять не обнуляється при створенні: сторінки розміщує перше заповнення потоками пулу
+struct FlatMatrix {
+    int size;
+    FirstTouchVector<int> data;
+
+    explicit FlatMatrix(int size) : size(size), data(size_t(size) * size) {}
+
+    int* operator[](int row) { return data.data() + size_t(row) * size; }
+    const int* operator[](int row) const { return data.data() + size_t(row) * size; }
+};
+
+int detectTileSize() {
+    if (TILE > 0) return TILE;
+
+    long l1Size = 32 * 1024;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    long detected = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (detected > 0) l1Size = detected;
+#endif
+    // Тайл джерела і тайл результату разом мають займати не більше половини L1
+    int tile = 8;
+    while (2L * (2 * tile) * (2 * tile) * long(sizeof(int)) <= l1Size / 2) {
+        tile *= 2;
+    }
+    return tile;
+}
+
+// Постійний пул: потоки створюються один раз і чекають на бар'єрі старту.
+// parallelFor ділить діапазон на рівні частини, викликаючий потік виконує нульову,
+// а бар'єр завершення повертає керування, коли всі частини готові.
+// Потік t закріплюється за ядром за політикою pin, тож частина t щоразу виконується на тому самому вузлі.
+// Викликаючий потік не закріплюється: нові потоки успадковують його маску, і еталонна версія з int**
+// опинилася б на одному ядрі
+class WorkerPool {
+private:
+    int numThreads;
+    vector<thread> workers;
+    barrier<> startBarrier;
+    barrier<> doneBarrier;
+    bool stop = false;
+
+    void (*job)(const void*, long long, long long) = nullptr;
+    const void* jobContext = nullptr;
+    long long jobBegin = 0;
+    long long jobEnd = 0;
+
+    void runPart(int part) {
+        long long count = jobEnd - jobBegin;
+        long long begin = jobBegin + count * part / numThreads;
+        long long end = jobBegin + count * (part + 1) / numThreads;
+        if (begin < end) job(jobContext, begin, end);
+    }
+
+public:
+    explicit WorkerPool(int numThreads, PinPolicy pin = PinPolicy::None)
+        : numThreads(numThreads), startBarrier(numThreads), doneBarrier(numThreads) {
+        for (int t = 1; t < numThreads; t++) {
+            workers.emplace_back([this, t, pin] {
+                pinCurrentThread(pin, t);
+                while (true) {
+                    startBarrier.arrive_and_wait();
+                    if (stop) return;
+                    runPart(t);
+                    doneBarrier.arrive_and_wait();
+                }
+            });
+        }
+    }
+
+    ~WorkerPool() {
+        stop = true;
+        startBarrier.arrive_and_wait();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    // func(begin, end) викликається для кожної непорожньої частини [begin, end)
+    template <typename Func>
+    void parallelFor(long long begin, long long end, const Func& func) {
+        job = [](const void* context, long long partBegin, long long partEnd) {
+            (*static_cast<const Func*>(context))(partBegin, partEnd);
+        };
+        jobContext = &func;
+        jobBegin = begin;
+        jobEnd = end;
+
+        startBarrier.arrive_and_wait();
+        runPart(0);
+        doneBarrier.arrive_and_wait();
+    }
+};
 
 int** allocateMatrix(int size) {
     int** matrix = new int*[size];
@@ -81,6 +189,38 @@ void mirrorMatrix(int** matrix, int size) {
     deallocateMatrix(mirrored, size);
 }
 
+void fillFlatPart(FlatMatrix& matrix, int startRow, int endRow, uint64_t seed) {
+    for (int i = startRow; i < endRow; i++) {
+        fillBoundedRandom(matrix[i], matrix.size, seed, uint64_t(i) * matrix.size, 0, 99);
+    }
+}
+
+void fillMatrix(FlatMatrix& matrix, WorkerPool& pool, uint64_t seed) {
+    pool.parallelFor(0, matrix.size, [&matrix, seed](long long startRow, long long endRow) {
+        fillFlatPart(matrix, int(startRow), int(endRow), seed);
+    });
+}
+
+void mirrorMatrix(FlatMatrix& matrix, WorkerPool& pool) {
+    static const int tile = detectTileSize();
+    pool.parallelFor(0, tileWeight(matrix.size, tile), [&matrix](long long firstWeight, long long lastWeight) {
+        mirrorTilePairs(matrix.data.data(), matrix.size, firstWeight, lastWeight, tile);
+    });
+}
+
+bool sameMatrix(const FlatMatrix& first, const FlatMatrix& second) {
+    return first.data == second.data;
+}
+
+bool sameMatrix(int** reference, const FlatMatrix& matrix) {
+    for (int i = 0; i < matrix.size; i++) {
+        for (int j = 0; j < matrix.size; j++) {
+            if (reference[i][j] != matrix[i][j]) return false;
+        }
+    }
+    return true;
+}
+
 void printMatrix(int** matrix, int size) {
     for (int i = 0; i < size; i++) {
         for (int j = 0; j < size; j++) {
@@ -93,15 +233,50 @@ void printMatrix(int** matrix, int size) {
 
 int main() {
     int** matrix = allocateMatrix(N);
+    FlatMatrix flat(N);
+    WorkerPool pool(THREADS, PIN);
+
+    // Заповнення пулом має збігатися з однопотоковим заповненням тим самим зерном.
+    // Воно ж перше торкається flat, тож рядки лягають на вузли потоків, що їх заповнюють
+    FlatMatrix sequential(N);
+    fillMatrix(flat, pool, SEED);
+    fillFlatPart(sequential, 0, N, SEED);
+    if (!sameMatrix(flat, sequential)) {
+        cerr << "Parallel fill depends on the thread count" << endl;
+        return 1;
+    }
+
+    // Перевірка: обидві реалізації мають давати однаковий результат на тих самих даних
+    fillMatrix(matrix, N);
+    for (int i = 0; i < N; i++) {
+        copy(matrix[i], matrix[i] + N, flat[i]);
+    }
+    mirrorMatrix(matrix, N);
+    mirrorMatrix(flat, pool);
+    if (!sameMatrix(matrix, flat)) {
+        cerr << "Tiled mirror differs from the reference implementation" << endl;
+        return 1;
+    }
 
-    clock_t startTime = clock();
+    auto startTime = high_resolution_clock::now();
     for (int iter = 0; iter < M; iter++) {
         fillMatrix(matrix, N);
         mirrorMatrix(matrix, N);
     }
-    clock_t endTime = clock();
-    double seconds = (double(endTime - startTime)) / CLOCKS_PER_SEC;
-    cout << "For " << M << " repetitions: " << seconds << " seconds" << endl;
+    auto endTime = high_resolution_clock::now();
+    double seconds = duration<double>(endTime - startTime).count();
+    cout << "Reference (int**, threads per call): for " << M << " repetitions: " << seconds << " seconds" << endl;
+
+    startTime = high_resolution_clock::now();
+    for (int iter = 0; iter < M; iter++) {
+        fillMatrix(flat, pool, SEED + iter);
+        mirrorMatrix(flat, pool);
+    }
+    endTime = high_resolution_clock::now();
+    double flatSeconds = duration<double>(endTime - startTime).count();
+    cout << "In-place, tile " << detectTileSize() << ", worker pool (pin " << pinPolicyName(PIN) << "): for " << M << " repetitions: "
+         << flatSeconds << " seconds" << endl;
+    cout << "Speedup: " << seconds / flatSeconds << "x" << endl;
 
     /*fillMatrix(matrix, N);
     cout << "First matrix:" << endl;
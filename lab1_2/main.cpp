@@ -1,11 +1,50 @@
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#include "../common/fast_random.h"
+#include "../common/tile_mirror.h"
 
 using namespace std;
+using namespace chrono;
 
 const int N = 1000; // Розмір квадратної матриці
 const int M = 1000;
+const int TILE = 0; // Сторона тайла для дзеркалення (0 - визначити за розміром L1-кешу)
+const uint64_t SEED = 2024; // Базове зерно генератора для суцільної матриці
+
+// Суцільна матриця з рядковим розміщенням: один блок пам'яті замість окремого new на кожен рядок
+struct FlatMatrix {
+    int size;
+    vector<int> data;
+
+    explicit FlatMatrix(int size) : size(size), data(size_t(size) * size) {}
+
+    int* operator[](int row) { return data.data() + size_t(row) * size; }
+    const int* operator[](int row) const { return data.data() + size_t(row) * size; }
+};
+
+int detectTileSize() {
+    if (TILE > 0) return TILE;
+
+    long l1Size = 32 * 1024;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    long detected = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (detected > 0) l1Size = detected;
+#endif
+    // Тайл джерела і тайл результату разом мають займати не більше половини L1
+    int tile = 8;
+    while (2L * (2 * tile) * (2 * tile) * long(sizeof(int)) <= l1Size / 2) {
+        tile *= 2;
+    }
+    return tile;
+}
 
 int** allocateMatrix(int size) {
     int** matrix = new int*[size];
@@ -57,17 +96,58 @@ void mirrorMatrix(int** matrix, int size) {
     deallocateMatrix(mirrored, size);
 }
 
+void fillMatrix(FlatMatrix& matrix, uint64_t seed) {
+    fillBoundedRandom(matrix.data.data(), matrix.data.size(), seed, 0, 0, 99);
+}
+
+void mirrorMatrix(FlatMatrix& matrix) {
+    static const int tile = detectTileSize();
+    mirrorTilePairs(matrix.data.data(), matrix.size, 0, tileWeight(matrix.size, tile), tile);
+}
+
+bool sameMatrix(int** reference, const FlatMatrix& matrix) {
+    for (int i = 0; i < matrix.size; i++) {
+        for (int j = 0; j < matrix.size; j++) {
+            if (reference[i][j] != matrix[i][j]) return false;
+        }
+    }
+    return true;
+}
+
 int main() {
     int** matrix = allocateMatrix(N);
+    FlatMatrix flat(N);
 
-    clock_t startTime = clock();
+    // Перевірка: обидві реалізації мають давати однаковий результат на тих самих даних
+    fillMatrix(matrix, N);
+    for (int i = 0; i < N; i++) {
+        copy(matrix[i], matrix[i] + N, flat[i]);
+    }
+    mirrorMatrix(matrix, N);
+    mirrorMatrix(flat);
+    if (!sameMatrix(matrix, flat)) {
+        cerr << "Tiled mirror differs from the reference implementation" << endl;
+        return 1;
+    }
+
+    auto startTime = high_resolution_clock::now();
     for (int iter = 0; iter < M; iter++) {
         fillMatrix(matrix, N);
         mirrorMatrix(matrix, N);
     }
-    clock_t endTime = clock();
-    double seconds = (double(endTime - startTime)) / CLOCKS_PER_SEC;
-    cout << "For " << M << " repetitions: " << seconds << " seconds" << endl;
+    auto endTime = high_resolution_clock::now();
+    double seconds = duration<double>(endTime - startTime).count();
+    cout << "Reference (int**): for " << M << " repetitions: " << seconds << " seconds" << endl;
+
+    startTime = high_resolution_clock::now();
+    for (int iter = 0; iter < M; iter++) {
+        fillMatrix(flat, SEED + iter);
+        mirrorMatrix(flat);
+    }
+    endTime = high_resolution_clock::now();
+    double flatSeconds = duration<double>(endTime - startTime).count();
+    cout << "In-place, tile " << detectTileSize() << ": for " << M << " repetitions: "
+         << flatSeconds << " seconds" << endl;
 
     /*fillMatrix(matrix, N);
     cout << "First matrix:" << endl;
@@ -3,6 +3,9 @@
 #include <cstdlib>
 #include <ctime>
 #include <chrono>  // Micro
+#include <cstdint>
+#include "../common/fast_random.h"
+#include "../common/filter_reduce.h"
 
 using namespace std;
 using namespace chrono;
@@ -11,25 +14,15 @@ const int SIZE = 1000000;
 const int MIN= 10;
 const int MAX = 10000;
 
-void generateRandomNumbers(vector<int>& numbers, int size, int min_val, int max_val) {
-    numbers.clear();
-    for (int i = 0; i < size; i++) {
-        numbers.push_back(min_val + rand() % (max_val - min_val + 1));
-    }
+void generateRandomNumbers(vector<int>& numbers, int size, int min_val, int max_val, uint64_t seed) {
+    numbers.resize(size);
+    fillBoundedRandom(numbers.data(), numbers.size(), seed, 0, min_val, max_val);
 }
 
 void findMultiplesOf17(const vector<int>& numbers, int& count, int& min_element) {
-    count = 0;
-    min_element = -1;
-
-    for (int num : numbers) {
-        if (num % 17 == 0) {
-            count++;
-            if (min_element == -1 || num < min_element) {
-                min_element = num;
-            }
-        }
-    }
+    auto result = filterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(numbers.data(), 0, numbers.size());
+    count = int(result.count);
+    min_element = result.min_element;
 }
 
 void printResults(int count, int min_element) {
@@ -42,13 +35,13 @@ void printResults(int count, int min_element) {
 }
 
 int main() {
-    srand(time(0));
+    uint64_t seed = time(0);
     vector<int> numbers;
     int count, min_element;
 
     auto startTime = high_resolution_clock::now();
 
-    generateRandomNumbers(numbers, SIZE, MIN, MAX);
+    generateRandomNumbers(numbers, SIZE, MIN, MAX, seed);
     findMultiplesOf17(numbers, count, min_element);
 
     auto endTime = high_resolution_clock::now();
@@ -3,48 +3,64 @@
 #include <ctime>
 #include <chrono>
 #include <thread>
-#include <mutex>
-#include <random>
+#include <cstdint>
+#include <algorithm>
+#include "../common/fast_random.h"
+#include "../common/filter_reduce.h"
+#include "../common/shared_count_min.h"
+#include "../common/affinity.h"
 
 using namespace std;
 using namespace chrono;
 
 const int NUM_THREADS = 6;
-const int ARRAY_SIZE = 1000000;
+const long long ARRAY_SIZE = 1000000;
 const int MIN = 10;
 const int MAX = 10000;
+const bool FUSED = true; // Генерувати і одразу сканувати блоками, не проходячи масив двічі
+const bool MATERIALIZE = false; // У злитому режимі все ж зберегти масив, якщо значення потрібні далі
+const int BLOCK_SIZE = 4096; // Елементів у блоці злитого режиму (16 КБ - вміщується в L1)
+const PinPolicy PIN = PinPolicy::Scatter; // Закріплення потоків за ядрами (None - на розсуд ОС)
+
+LockedCountMin total; // Підсумки потоків зливаються сюди під м'ютексом
+
+// Потік номер index закріплюється за ядром до виклику func, тож фрагмент, який він згенерував
+// (і першим торкнувся), у двопрохідному режимі сканує потік на тому самому вузлі
+template <typename Func, typename... Args>
+thread startPinned(int index, Func func, Args... args) {
+    return thread([=]() mutable {
+        pinCurrentThread(PIN, index);
+        func(args...);
+    });
+}
 
-mutex mtx;
-
-void generateRandomNumbers(vector<int>& numbers, int min_val, int max_val, int startIdx, int endIdx, int thread_id) {
-    mt19937 rng(steady_clock::now().time_since_epoch().count() + thread_id);
-    uniform_int_distribution<int> dist(min_val, max_val);
-    for (int i = startIdx; i < endIdx; ++i) {
-        numbers[i] = dist(rng);
-    }
+void generateRandomNumbers(FirstTouchVector<int>& numbers, int min_val, int max_val, long long startIdx, long long endIdx, uint64_t seed) {
+    fillBoundedRandom(numbers.data() + startIdx, endIdx - startIdx, seed, startIdx, min_val, max_val);
 }
 
-void findMultiplesOf17(const vector<int>& numbers, int startIdx, int endIdx, int& count, int& min_element) {
-    int local_count = 0;
-    int local_min_element = -1;
+void findMultiplesOf17(const FirstTouchVector<int>& numbers, long long startIdx, long long endIdx) {
+    scanChunkLocked<17>(numbers.data(), startIdx, endIdx, total);
+}
 
-    for (int i = startIdx; i < endIdx; ++i) {
-        if (numbers[i] % 17 == 0) {
-            local_count++;
-            if (local_min_element == -1 || numbers[i] < local_min_element) {
-                local_min_element = numbers[i];
-            }
-        }
+// Злитий режим: кожен блок генерується і одразу сканується, поки він ще в кеші.
+// Якщо numbers == nullptr, блок пишеться в локальний буфер і масив не зберігається взагалі,
+// тож розмір обмежений лише часом, а не пам'яттю
+void generateAndFindMultiplesOf17(int* numbers, int min_val, int max_val, long long startIdx, long long endIdx,
+                                  uint64_t seed) {
+    vector<int> buffer(numbers ? 0 : BLOCK_SIZE);
+    FilterReduceResult<CountAggregate, MinAggregate> local;
+
+    for (long long blockStart = startIdx; blockStart < endIdx; blockStart += BLOCK_SIZE) {
+        long long blockSize = min<long long>(BLOCK_SIZE, endIdx - blockStart);
+        int* block = numbers ? numbers + blockStart : buffer.data();
+        fillBoundedRandom(block, blockSize, seed, blockStart, min_val, max_val);
+        local.merge(filterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(block, 0, blockSize));
     }
 
-    lock_guard<mutex> lock(mtx);
-    count += local_count;
-    if (local_min_element != -1 && (min_element == -1 || local_min_element < min_element)) {
-        min_element = local_min_element;
-    }
+    total.merge(local.count, local.min_element);
 }
 
-void printResults(int count, int min_element) {
+void printResults(long long count, int min_element) {
     if (count > 0) {
         cout << "Number of elements divisible by 17: " << count << endl;
         cout << "Smallest element divisible by 17: " << min_element << endl;
@@ -54,43 +70,56 @@ void printResults(int count, int min_element) {
 }
 
 int main() {
-    vector<int> numbers(ARRAY_SIZE);
-    int count = 0;
-    int min_element = -1;
+    // Без обнулення: сторінки розміщує потік, що генерує свій фрагмент
+    FirstTouchVector<int> numbers(!FUSED || MATERIALIZE ? ARRAY_SIZE : 0);
 
+    uint64_t seed = steady_clock::now().time_since_epoch().count();
     auto startTime = high_resolution_clock::now();
 
     vector<thread> threads;
-    int chunkSize = ARRAY_SIZE / NUM_THREADS;
-    int remainder = ARRAY_SIZE % NUM_THREADS;
-
-    int startIdx = 0;
-    for (int i = 0; i < NUM_THREADS; ++i) {
-        int endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
-        threads.emplace_back(generateRandomNumbers, ref(numbers), MIN, MAX, startIdx, endIdx, i);
-        startIdx = endIdx;
-    }
+    long long chunkSize = ARRAY_SIZE / NUM_THREADS;
+    long long remainder = ARRAY_SIZE % NUM_THREADS;
+
+    long long startIdx = 0;
+    if (FUSED) {
+        int* storage = MATERIALIZE ? numbers.data() : nullptr;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            long long endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
+            threads.push_back(startPinned(i, generateAndFindMultiplesOf17, storage, MIN, MAX, startIdx, endIdx, seed));
+            startIdx = endIdx;
+        }
 
-    for (auto& t : threads) {
-        t.join();
-    }
+        for (auto& t : threads) {
+            t.join();
+        }
+    } else {
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            long long endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
+            threads.push_back(startPinned(i, generateRandomNumbers, ref(numbers), MIN, MAX, startIdx, endIdx, seed));
+            startIdx = endIdx;
+        }
 
-    threads.clear();
-    startIdx = 0;
-    for (int i = 0; i < NUM_THREADS; ++i) {
-        int endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
-        threads.emplace_back(findMultiplesOf17, cref(numbers), startIdx, endIdx, ref(count), ref(min_element));
-        startIdx = endIdx;
-    }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        threads.clear();
+        startIdx = 0;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            long long endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
+            threads.push_back(startPinned(i, findMultiplesOf17, cref(numbers), startIdx, endIdx));
+            startIdx = endIdx;
+        }
 
-    for (auto& t : threads) {
-        t.join();
+        for (auto& t : threads) {
+            t.join();
+        }
     }
 
     auto endTime = high_resolution_clock::now();
     auto duration = duration_cast<microseconds>(endTime - startTime);
 
-    printResults(count, min_element);
+    printResults(total.count, total.min_element);
     cout << "Time: " << duration.count() << " microseconds" << endl;
 
     /*for (int i = 0; i < ARRAY_SIZE; ++i) {
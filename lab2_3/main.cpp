@@ -2,46 +2,84 @@
 #include <vector>
 #include <atomic>
 #include <thread>
-#include <random>
 #include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <ctime>
+#include "../common/fast_random.h"
+#include "../common/filter_reduce.h"
+#include "../common/shared_count_min.h"
 
 using namespace std;
 using namespace chrono;
 
-const int ARRAY_SIZE = 20;
+const long long ARRAY_SIZE = 50000000;
 const int MIN_VAL = 0;
 const int MAX_VAL = 10000;
 const int NUM_THREADS = 6;
+const bool ATOMIC_STORAGE = false; // true - vector<atomic<int>>, false - звичайний vector<int>
+const bool PER_THREAD_REDUCTION = true; // true - часткові результати потоків, false - спільні атомарні лічильники
+const long long PRINT_LIMIT = 100; // Масив друкується, лише якщо він не більший за цей розмір
+
+vector<atomic<int>> atomic_numbers(ATOMIC_STORAGE ? ARRAY_SIZE : 0);
+vector<int> plain_numbers(ATOMIC_STORAGE ? 0 : ARRAY_SIZE);
+AtomicCountMin shared; // Спільні лічильники; у режимі часткових результатів сюди потрапляє злитий підсумок
+vector<PaddedCountMin> partials(NUM_THREADS);
+
+void generateRandomNumbers(long long start, long long end, uint64_t seed) {
+    if (!ATOMIC_STORAGE) {
+        fillBoundedRandom(plain_numbers.data() + start, end - start, seed, start, MIN_VAL, MAX_VAL);
+        return;
+    }
 
-vector<atomic<int>> random_numbers(ARRAY_SIZE);
-atomic<int> count_17(0);
-atomic<int> min_val(MAX_VAL + 1);
+    const int BLOCK = 1024;
+    int block[BLOCK];
+    for (long long i = start; i < end; i += BLOCK) {
+        int count = int(min<long long>(BLOCK, end - i));
+        fillBoundedRandom(block, count, seed, i, MIN_VAL, MAX_VAL);
+        for (int k = 0; k < count; k++) {
+            atomic_numbers[i + k].store(block[k], memory_order_relaxed);
+        }
+    }
+}
 
-void generateRandomNumbers(int start, int end, int seed) {
-    mt19937 rng(seed);
-    uniform_int_distribution<int> dist(MIN_VAL, MAX_VAL);
-    for (int i = start; i < end; i++) {
-        int random_value = dist(rng);
-        random_numbers[i].store(random_value, memory_order_relaxed);
+template <typename T>
+void scanRange(const T* data, int thread_id, long long start, long long end) {
+    if (PER_THREAD_REDUCTION) {
+        scanChunkPartial<17>(data, start, end, partials[thread_id]);
+    } else {
+        scanChunkAtomic<17>(data, start, end, shared);
     }
 }
 
-void findMultiplesOf17(int start, int end) {
-    for (int i = start; i < end; i++) {
-        int value = random_numbers[i].load(memory_order_relaxed);
-        if (value % 17 == 0) {
-            count_17.fetch_add(1, memory_order_relaxed);
-            int current_min = min_val.load(memory_order_relaxed);
-            while (value < current_min &&
-                   !min_val.compare_exchange_weak(current_min, value, memory_order_relaxed));
-        }
+void findMultiplesOf17(int thread_id, long long start, long long end) {
+    if (ATOMIC_STORAGE) {
+        scanRange(atomic_numbers.data(), thread_id, start, end);
+    } else {
+        scanRange(plain_numbers.data(), thread_id, start, end);
     }
 }
 
+// Часткові результати зливаються один раз, після завершення всіх потоків
+void combinePartials() {
+    FilterReduceResult<CountAggregate, MinAggregate> total;
+    for (const PaddedCountMin& partial : partials) {
+        total.merge(partial.result);
+    }
+    shared.count.store(total.count, memory_order_relaxed);
+    if (total.has_min) {
+        shared.min_element.store(total.min_element, memory_order_relaxed);
+    }
+}
+
+int valueAt(long long i) {
+    return ATOMIC_STORAGE ? atomic_numbers[i].load(memory_order_relaxed) : plain_numbers[i];
+}
+
 void printResults() {
-    int final_min = min_val.load(memory_order_relaxed);
-    if (count_17.load(memory_order_relaxed) > 0 && final_min <= MAX_VAL) {
-        cout << "Number of elements divisible by 17: " << count_17.load(memory_order_relaxed) << endl;
+    int final_min = shared.min_element.load(memory_order_relaxed);
+    if (shared.count.load(memory_order_relaxed) > 0 && final_min <= MAX_VAL) {
+        cout << "Number of elements divisible by 17: " << shared.count.load(memory_order_relaxed) << endl;
         cout << "Minimum of those elements: " << final_min << endl;
     } else {
         cout << "No elements divisible by 17 found." << endl;
@@ -50,37 +88,43 @@ void printResults() {
 
 int main() {
     vector<thread> threads;
+    uint64_t seed = time(0);
 
     auto startTime = high_resolution_clock::now();
 
-    int chunk_size = ARRAY_SIZE / NUM_THREADS;
+    long long chunk_size = ARRAY_SIZE / NUM_THREADS;
     for (int i = 0; i < NUM_THREADS; i++) {
-        int start = i * chunk_size;
-        int end = (i == NUM_THREADS - 1) ? ARRAY_SIZE : start + chunk_size;
-        threads.emplace_back(generateRandomNumbers, start, end, rand());
+        long long start = i * chunk_size;
+        long long end = (i == NUM_THREADS - 1) ? ARRAY_SIZE : start + chunk_size;
+        threads.emplace_back(generateRandomNumbers, start, end, seed);
     }
 
     for (auto& t : threads) t.join();
     threads.clear();
 
     for (int i = 0; i < NUM_THREADS; i++) {
-        int start = i * chunk_size;
-        int end = (i == NUM_THREADS - 1) ? ARRAY_SIZE : start + chunk_size;
-        threads.emplace_back(findMultiplesOf17, start, end);
+        long long start = i * chunk_size;
+        long long end = (i == NUM_THREADS - 1) ? ARRAY_SIZE : start + chunk_size;
+        threads.emplace_back(findMultiplesOf17, i, start, end);
     }
 
     for (auto& t : threads) t.join();
+    if (PER_THREAD_REDUCTION) combinePartials();
 
     auto endTime = high_resolution_clock::now();
     auto duration = duration_cast<microseconds>(endTime - startTime);
 
+    cout << "Storage: " << (ATOMIC_STORAGE ? "atomic<int>" : "int")
+         << ", reduction: " << (PER_THREAD_REDUCTION ? "per-thread" : "shared atomics") << endl;
     printResults();
     cout << "Time: " << duration.count() << " microseconds" << endl;
 
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        cout << random_numbers[i].load(memory_order_relaxed) << " ";
+    if (ARRAY_SIZE <= PRINT_LIMIT) {
+        for (long long i = 0; i < ARRAY_SIZE; i++) {
+            cout << valueAt(i) << " ";
+        }
+        cout << endl;
     }
-    cout << endl;
 
     return 0;
 }
@@ -0,0 +1,366 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include "../common/fast_random.h"
+#include "../common/filter_reduce.h"
+#include "../common/shared_count_min.h"
+
+using namespace std;
+using namespace chrono;
+
+// Єдиний бенчмарк для варіантів lab2: послідовного, з м'ютексом, з атомарними лічильниками,
+// з частковими результатами потоків і векторного. Усі стратегії отримують той самий масив.
+// Використання: lab2_bench [--sizes=1000000,10000000] [--threads=1,2,6] [--trials=11] [--warmup=2] [--format=csv|json]
+//                lab2_bench --self-test
+
+const int MIN = 10;
+const int MAX = 10000;
+const uint64_t SEED = 2024;
+const long long MAX_SIZE = 4000000000LL; // Елементів у масиві (16 ГБ)
+const long long MAX_THREADS = 1024;
+
+struct ScanResult {
+    long long count = 0;
+    int min_element = -1;
+};
+
+struct Strategy {
+    string name;
+    bool parallel;
+    function<ScanResult(const vector<int>&, int)> scan;
+};
+
+struct Stats {
+    double median;
+    double p95;
+};
+
+template <typename Func>
+void forEachChunk(size_t size, int numThreads, Func func) {
+    vector<thread> threads;
+    size_t chunkSize = size / numThreads;
+    size_t remainder = size % numThreads;
+    size_t startIdx = 0;
+    for (int t = 0; t < numThreads; ++t) {
+        size_t endIdx = startIdx + chunkSize + (size_t(t) < remainder ? 1 : 0);
+        threads.emplace_back(func, t, startIdx, endIdx);
+        startIdx = endIdx;
+    }
+    for (auto& t : threads) t.join();
+}
+
+void generateNumbers(vector<int>& numbers, int numThreads) {
+    forEachChunk(numbers.size(), numThreads, [&numbers](int, size_t startIdx, size_t endIdx) {
+        fillBoundedRandom(numbers.data() + startIdx, endIdx - startIdx, SEED, startIdx, MIN, MAX);
+    });
+}
+
+// Скалярний послідовний прохід, як у lab2_1 до переходу на filter/reduce: з ним звіряються решта стратегій
+ScanResult scanSequential(const vector<int>& numbers, int) {
+    ScanResult result;
+    for (int num : numbers) {
+        if (num % 17 == 0) {
+            result.count++;
+            if (result.min_element == -1 || num < result.min_element) {
+                result.min_element = num;
+            }
+        }
+    }
+    return result;
+}
+
+// Стратегії lab2_2 і lab2_3 - той самий код, що в лабах (shared_count_min.h), на фрагментах forEachChunk
+
+// Локальний підрахунок у фрагменті і злиття під м'ютексом (lab2_2)
+ScanResult scanMutex(const vector<int>& numbers, int numThreads) {
+    LockedCountMin total;
+    forEachChunk(numbers.size(), numThreads, [&](int, size_t startIdx, size_t endIdx) {
+        scanChunkLocked<17>(numbers.data(), startIdx, endIdx, total);
+    });
+    return {total.count, total.min_element};
+}
+
+// fetch_add і CAS на спільних атомарних змінних для кожного знайденого елемента (lab2_3)
+ScanResult scanAtomic(const vector<int>& numbers, int numThreads) {
+    AtomicCountMin total;
+    forEachChunk(numbers.size(), numThreads, [&](int, size_t startIdx, size_t endIdx) {
+        scanChunkAtomic<17>(numbers.data(), startIdx, endIdx, total);
+    });
+    ScanResult result;
+    result.count = total.count.load();
+    result.min_element = result.count > 0 ? total.min_element.load() : -1;
+    return result;
+}
+
+// Часткові результати в окремих кеш-лініях, злиття після join (lab2_3)
+ScanResult scanPerThread(const vector<int>& numbers, int numThreads) {
+    vector<PaddedCountMin> partials(numThreads);
+    forEachChunk(numbers.size(), numThreads, [&](int t, size_t startIdx, size_t endIdx) {
+        scanChunkPartial<17>(numbers.data(), startIdx, endIdx, partials[t]);
+    });
+    FilterReduceResult<CountAggregate, MinAggregate> total;
+    for (const PaddedCountMin& partial : partials) total.merge(partial.result);
+    return {total.count, total.min_element};
+}
+
+// Векторне ядро через filter/reduce (паралельно; з одним потоком - без створення потоків)
+ScanResult scanSimd(const vector<int>& numbers, int numThreads) {
+    FilterReduceResult<CountAggregate, MinAggregate> reduced;
+    if (numThreads == 1) {
+        reduced = filterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(numbers.data(), 0, numbers.size());
+    } else {
+        reduced = parallelFilterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(numbers, numThreads);
+    }
+    ScanResult result;
+    result.count = reduced.count;
+    result.min_element = reduced.min_element;
+    return result;
+}
+
+Stats summarize(vector<double> samples) {
+    sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    double median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    size_t p95Index = min(n - 1, size_t((n - 1) * 0.95 + 0.5));
+    return {median, samples[p95Index]};
+}
+
+template <typename Func>
+Stats measure(int warmup, int trials, Func func) {
+    for (int i = 0; i < warmup; i++) func();
+    vector<double> samples;
+    for (int i = 0; i < trials; i++) {
+        auto startTime = high_resolution_clock::now();
+        func();
+        auto endTime = high_resolution_clock::now();
+        samples.push_back(duration<double>(endTime - startTime).count());
+    }
+    return summarize(samples);
+}
+
+// Самоперевірка filter/reduce (--self-test): кожен агрегат і кожен предикат порівнюються з наївним циклом
+// на повному масиві, на підмасиві (індекси глобальні) і в паралельному варіанті
+struct NaiveScan {
+    long long count = 0;
+    long long sum = 0;
+    long long first_index = -1;
+    int min_element = -1;
+    int max_element = -1;
+};
+
+template <typename Predicate>
+NaiveScan naiveScan(const vector<int>& numbers, size_t begin, size_t end, Predicate predicate) {
+    NaiveScan expected;
+    for (size_t i = begin; i < end; i++) {
+        int value = numbers[i];
+        if (!predicate(value)) continue;
+        if (expected.count == 0) {
+            expected.first_index = (long long)i;
+            expected.min_element = value;
+            expected.max_element = value;
+        }
+        expected.count++;
+        expected.sum += value;
+        expected.min_element = min(expected.min_element, value);
+        expected.max_element = max(expected.max_element, value);
+    }
+    return expected;
+}
+
+using FullResult = FilterReduceResult<CountAggregate, MinAggregate, MaxAggregate, SumAggregate, FirstIndexAggregate>;
+
+bool sameScan(const FullResult& result, const NaiveScan& expected) {
+    return result.count == expected.count && result.sum == expected.sum && result.first_index == expected.first_index &&
+           result.min_element == expected.min_element && result.max_element == expected.max_element &&
+           result.has_min == (expected.count > 0) && result.has_max == (expected.count > 0);
+}
+
+template <typename Predicate>
+bool checkPredicate(const string& name, const vector<int>& numbers, Predicate predicate) {
+    bool ok = true;
+    auto expect = [&](bool condition, const string& what) {
+        if (!condition) cerr << "[self-test] " << name << ", size " << numbers.size() << ": " << what << endl;
+        ok = ok && condition;
+    };
+
+    size_t n = numbers.size();
+    NaiveScan whole = naiveScan(numbers, 0, n, predicate);
+    expect(sameScan(filterReduce<Predicate, CountAggregate, MinAggregate, MaxAggregate, SumAggregate,
+                                 FirstIndexAggregate>(numbers.data(), 0, n, predicate), whole),
+           "all aggregates");
+
+    size_t begin = n / 3;
+    size_t end = n - n / 4;
+    expect(sameScan(filterReduce<Predicate, CountAggregate, MinAggregate, MaxAggregate, SumAggregate,
+                                 FirstIndexAggregate>(numbers.data(), begin, end, predicate),
+                    naiveScan(numbers, begin, end, predicate)),
+           "subrange");
+
+    // Окремо пара "кількість + мінімум": для DivisibleBy вона йде через векторне ядро
+    auto countMin = filterReduce<Predicate, CountAggregate, MinAggregate>(numbers.data(), 0, n, predicate);
+    expect(countMin.count == whole.count && countMin.min_element == whole.min_element, "count + min");
+
+    for (int threads : {1, 3, 7}) {
+        auto parallel = parallelFilterReduce<Predicate, CountAggregate, MinAggregate, MaxAggregate, SumAggregate,
+                                             FirstIndexAggregate>(numbers, threads, predicate);
+        expect(sameScan(parallel, whole), "parallel, " + to_string(threads) + " threads");
+    }
+    return ok;
+}
+
+int runSelfTests() {
+    bool ok = true;
+    for (size_t size : {size_t(0), size_t(1), size_t(5), size_t(1000), size_t(100003)}) {
+        vector<int> numbers(size);
+        fillBoundedRandom(numbers.data(), size, SEED, 0, MIN, MAX);
+        ok = checkPredicate("divisible by 17", numbers, DivisibleBy<17>()) && ok;
+        ok = checkPredicate("divisible by 5", numbers, DivisibleBy<5>()) && ok;
+        ok = checkPredicate("range [100, 2000]", numbers, InRange{100, 2000}) && ok;
+        ok = checkPredicate("range [MAX, MAX]", numbers, InRange{MAX, MAX}) && ok;
+        ok = checkPredicate("empty range", numbers, InRange{1, 0}) && ok;
+    }
+    cout << (ok ? "All self-tests passed\n" : "Self-tests failed\n");
+    return ok ? 0 : 1;
+}
+
+// Список цілих з [1, maxValue] через кому; допускається запис на кшталт 1e7. false - значення, яке не розібрати
+bool parseList(const string& name, const string& text, long long maxValue, vector<long long>& values) {
+    values.clear();
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        char* end = nullptr;
+        double value = item.empty() ? 0 : strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || !(value >= 1 && value <= double(maxValue)) || value != floor(value)) {
+            cerr << "Invalid " << name << " value: '" << item << "' (expected integers from 1 to " << maxValue << ")"
+                 << endl;
+            return false;
+        }
+        values.push_back((long long)value);
+    }
+    if (values.empty()) {
+        cerr << "Empty " << name << " list" << endl;
+        return false;
+    }
+    return true;
+}
+
+struct Row {
+    string strategy;
+    long long size;
+    int threads;
+    Stats generate;
+    Stats scan;
+    ScanResult result;
+};
+
+void printCsv(const vector<Row>& rows) {
+    cout << "strategy,size,threads,generate_median_s,generate_p95_s,scan_median_s,scan_p95_s,"
+            "elements_per_s,gb_per_s,count,min_element\n";
+    for (const Row& row : rows) {
+        double elementsPerSecond = row.size / row.scan.median;
+        cout << row.strategy << "," << row.size << "," << row.threads << ","
+             << row.generate.median << "," << row.generate.p95 << ","
+             << row.scan.median << "," << row.scan.p95 << ","
+             << elementsPerSecond << "," << elementsPerSecond * sizeof(int) / 1e9 << ","
+             << row.result.count << "," << row.result.min_element << "\n";
+    }
+}
+
+void printJson(const vector<Row>& rows) {
+    cout << "[\n";
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Row& row = rows[i];
+        double elementsPerSecond = row.size / row.scan.median;
+        cout << "  {\"strategy\": \"" << row.strategy << "\", \"size\": " << row.size
+             << ", \"threads\": " << row.threads
+             << ", \"generate_median_s\": " << row.generate.median << ", \"generate_p95_s\": " << row.generate.p95
+             << ", \"scan_median_s\": " << row.scan.median << ", \"scan_p95_s\": " << row.scan.p95
+             << ", \"elements_per_s\": " << elementsPerSecond
+             << ", \"gb_per_s\": " << elementsPerSecond * sizeof(int) / 1e9
+             << ", \"count\": " << row.result.count << ", \"min_element\": " << row.result.min_element << "}"
+             << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    cout << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+    vector<long long> sizes = {100000, 1000000, 10000000};
+    vector<long long> threadCounts = {1, 2, 6};
+    int trials = 11;
+    int warmup = 2;
+    string format = "csv";
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--self-test") return runSelfTests();
+        string value = arg.substr(arg.find('=') + 1);
+        if (arg.rfind("--sizes=", 0) == 0) {
+            if (!parseList("--sizes", value, MAX_SIZE, sizes)) return 1;
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            if (!parseList("--threads", value, MAX_THREADS, threadCounts)) return 1;
+        } else if (arg.rfind("--trials=", 0) == 0) {
+            trials = max(1, atoi(value.c_str()));
+        } else if (arg.rfind("--warmup=", 0) == 0) {
+            warmup = max(0, atoi(value.c_str()));
+        } else if (arg.rfind("--format=", 0) == 0) {
+            format = value;
+        } else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+    if (format != "csv" && format != "json") {
+        cerr << "Unknown format: " << format << " (expected csv or json)" << endl;
+        return 1;
+    }
+
+    vector<Strategy> strategies = {
+        {"sequential", false, scanSequential},
+        {"mutex", true, scanMutex},
+        {"atomic", true, scanAtomic},
+        {"per_thread", true, scanPerThread},
+        {"simd", true, scanSimd},
+    };
+
+    vector<Row> rows;
+    bool consistent = true;
+    for (long long size : sizes) {
+        vector<int> numbers(size);
+        ScanResult expected = {};
+        bool haveExpected = false;
+
+        for (const Strategy& strategy : strategies) {
+            vector<long long> strategyThreads = strategy.parallel ? threadCounts : vector<long long>{1};
+            for (long long threads : strategyThreads) {
+
+                Row row{strategy.name, size, int(threads), {}, {}, {}};
+                row.generate = measure(warmup, trials, [&] { generateNumbers(numbers, int(threads)); });
+                row.scan = measure(warmup, trials, [&] { row.result = strategy.scan(numbers, int(threads)); });
+
+                if (!haveExpected) {
+                    expected = row.result;
+                    haveExpected = true;
+                } else if (row.result.count != expected.count || row.result.min_element != expected.min_element) {
+                    cerr << "[bench] " << strategy.name << " with " << threads << " threads disagrees on size "
+                         << size << endl;
+                    consistent = false;
+                }
+                rows.push_back(row);
+            }
+        }
+    }
+
+    if (format == "json") printJson(rows);
+    else printCsv(rows);
+
+    return consistent ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <queue>
+#include <deque>
 #include <vector>
 #include <thread>
 #include <mutex>
@@ -8,120 +9,1415 @@
 #include <chrono>
 #include <random>
 #include <fstream>
-#include <ctime>
 #include <atomic>
+#include <memory>
+#include <string>
+#include <optional>
+#include <iomanip>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <array>
+#include <algorithm>
+#include <sstream>
+#include <bit>
+#include <variant>
+#include <exception>
+#include <stdexcept>
+#include <cstdint>
+#include "../common/fast_random.h"
+#include "../common/filter_reduce.h"
+#include "../common/affinity.h"
+#include "../common/tile_mirror.h"
+
+// Лічильник звернень до operator new - для --bench-alloc. Заміна глобального operator new додає
+// атомарну операцію до кожного виділення в усій програмі й спотворювала б решту бенчмарків,
+// тож вона є лише в збірці з -DLAB3_COUNT_ALLOCATIONS.
+// noinline не дає GCC вбудувати заміну й хибно вважати, що free звільняє пам'ять від new
+#ifdef LAB3_COUNT_ALLOCATIONS
+#if defined(__GNUC__)
+#define ALLOCATOR_NOINLINE __attribute__((noinline))
+#else
+#define ALLOCATOR_NOINLINE
+#endif
+
+std::atomic<long long> allocationCount{0};
+
+ALLOCATOR_NOINLINE void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+ALLOCATOR_NOINLINE void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+// Викликуваний об'єкт задачі лише з переміщенням і вбудованим буфером: замикання до INLINE_SIZE байт
+// зберігаються всередині об'єкта без виділення пам'яті, більші - в купі
+class TaskFunction {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    TaskFunction() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, TaskFunction>>>
+    TaskFunction(F&& func) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fitsInline<Fn>()) {
+            new (storage) Fn(std::forward<F>(func));
+            ops = &inlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(func));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    TaskFunction(TaskFunction&& other) noexcept {
+        moveFrom(other);
+    }
+
+    TaskFunction& operator=(TaskFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    TaskFunction(const TaskFunction&) = delete;
+    TaskFunction& operator=(const TaskFunction&) = delete;
+
+    ~TaskFunction() {
+        reset();
+    }
+
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const {
+        return ops != nullptr;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* to, void* from);
+        void (*destroy)(void*);
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops inlineOps = {
+        [](void* self) { (*static_cast<Fn*>(self))(); },
+        [](void* to, void* from) {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* self) { static_cast<Fn*>(self)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops heapOps = {
+        [](void* self) { (**static_cast<Fn**>(self))(); },
+        [](void* to, void* from) { *static_cast<Fn**>(to) = *static_cast<Fn**>(from); },
+        [](void* self) { delete *static_cast<Fn**>(self); },
+    };
+
+    void moveFrom(TaskFunction& other) {
+        ops = other.ops;
+        if (ops) ops->move(storage, other.storage);
+        other.ops = nullptr;
+    }
+
+    void reset() {
+        if (ops) ops->destroy(storage);
+        ops = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Класи пріоритету: чутливі до затримки задачі обслуговуються раніше за пакетні
+enum class TaskClass {
+    Interactive,
+    Batch
+};
+
+const int TASK_CLASSES = 2;
+
+const char* taskClassName(TaskClass taskClass) {
+    return taskClass == TaskClass::Interactive ? "interactive" : "batch";
+}
 
 struct Task {
-    int id;
+    int id = 0;
+    int duration = 0;
+    TaskFunction func;
+    TaskClass taskClass = TaskClass::Batch;
+    Clock::time_point enqueueTime;
+    Clock::time_point deadline;
+
+    Task() = default;
+
+    // Без явного дедлайну (deadlineSeconds < 0) задача має завершитися за свою ж оцінку тривалості
+    Task(int id, int duration, TaskFunction func, TaskClass taskClass = TaskClass::Batch, int deadlineSeconds = -1)
+        : id(id), duration(duration), func(std::move(func)), taskClass(taskClass), enqueueTime(Clock::now()),
+          deadline(enqueueTime + std::chrono::seconds(deadlineSeconds >= 0 ? deadlineSeconds : duration)) {}
+};
+
+// Кільцевий буфер задач: комірки перевикористовуються, пам'ять виділяється лише коли буфер росте
+class TaskRing {
+private:
+    std::vector<Task> slots;
+    size_t head = 0;
+    size_t count = 0;
+
+    void grow() {
+        std::vector<Task> bigger(slots.size() * 2);
+        for (size_t i = 0; i < count; ++i) {
+            bigger[i] = std::move(slots[(head + i) % slots.size()]);
+        }
+        slots.swap(bigger);
+        head = 0;
+    }
+
+public:
+    explicit TaskRing(size_t capacity = 64) : slots(capacity) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    Task& front() { return slots[head]; }
+    Task& back() { return slots[(head + count - 1) % slots.size()]; }
+    Task& at(size_t i) { return slots[(head + i) % slots.size()]; }
+
+    void push_back(Task&& task) {
+        if (count == slots.size()) grow();
+        slots[(head + count) % slots.size()] = std::move(task);
+        count++;
+    }
+
+    void pop_front() {
+        front() = Task();
+        head = (head + 1) % slots.size();
+        count--;
+    }
+
+    void pop_back() {
+        back() = Task();
+        count--;
+    }
+
+    // Видалення з середини за O(1): на місце i переноситься перша задача, тож порядок FIFO не зберігається
+    void removeAt(size_t i) {
+        if (i != 0) at(i) = std::move(front());
+        pop_front();
+    }
+
+    void clear() {
+        while (!empty()) pop_front();
+    }
+
+    void swap(TaskRing& other) noexcept {
+        slots.swap(other.slots);
+        std::swap(head, other.head);
+        std::swap(count, other.count);
+    }
+};
+
+// Чим закінчилося додавання в чергу: Full буває лише в обмеженого кільця LockFreeTaskQueue
+enum class EnqueueResult {
+    Added,
+    OverBudget, // сумарна оцінка перевищила б maxTime
+    Full        // кільце заповнене, бюджет тут ні до чого
+};
+
+enum class QueueOrdering {
+    Fifo,             // у порядку надходження, класи ігноруються
+    EarliestDeadline, // спершу вищий клас, у межах класу - найближчий дедлайн
+    ShortestJob       // спершу вищий клас, у межах класу - найменша оцінка duration
+};
+
+class TaskQueue {
+private:
+    TaskRing tasks;
+    std::mutex queue_mtx;
+    int totalExecutionTime;
+    int maxTime;
+    int totalTasks;
+    int totalTasksWaiting;
+    bool verbose = true;
+    QueueOrdering ordering = QueueOrdering::Fifo;
+    int agingSeconds = 0;
+
+    // Старіння проти голодування: кожні agingSeconds очікування піднімають задачу на один клас
+    int effectiveClass(const Task& task, Clock::time_point now) const {
+        int rank = int(task.taskClass);
+        if (agingSeconds > 0) {
+            auto waited = std::chrono::duration_cast<std::chrono::seconds>(now - task.enqueueTime).count();
+            rank -= int(waited / agingSeconds);
+        }
+        return std::max(rank, 0);
+    }
+
+    bool runsBefore(const Task& a, const Task& b, Clock::time_point now) const {
+        int classA = effectiveClass(a, now);
+        int classB = effectiveClass(b, now);
+        if (classA != classB) return classA < classB;
+        if (ordering == QueueOrdering::EarliestDeadline && a.deadline != b.deadline) return a.deadline < b.deadline;
+        if (ordering == QueueOrdering::ShortestJob && a.duration != b.duration) return a.duration < b.duration;
+        return a.enqueueTime < b.enqueueTime;
+    }
+
+    // Черга коротка (сумарний час обмежений maxTime), тож лінійний перегляд дешевший за купу
+    size_t selectNext() {
+        if (ordering == QueueOrdering::Fifo) return 0;
+        Clock::time_point now = Clock::now();
+        size_t best = 0;
+        for (size_t i = 1; i < tasks.size(); ++i) {
+            if (runsBefore(tasks.at(i), tasks.at(best), now)) best = i;
+        }
+        return best;
+    }
+
+public:
+    TaskQueue() : totalExecutionTime(0), maxTime(60), totalTasks(0), totalTasksWaiting(0) {}
+
+    void setVerbose(bool value) {
+        verbose = value;
+    }
+
+    void setMaxTime(int value) {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        maxTime = value;
+    }
+
+    int getQueuedTime() {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        return totalExecutionTime;
+    }
+
+    void setOrdering(QueueOrdering value, int aging) {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        ordering = value;
+        agingSeconds = aging;
+    }
+
+    ~TaskQueue() {
+        clear();
+    }
+
+    template <typename F>
+    EnqueueResult addTask(int id, int estimatedTime, F&& taskFunc, TaskClass taskClass = TaskClass::Batch,
+                          int deadlineSeconds = -1) {
+        bool added = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            totalTasks++;
+            // Порожня черга приймає будь-яку задачу, інакше задача, більша за бюджет, не пройшла б ніколи
+            if (estimatedTime + totalExecutionTime <= maxTime || tasks.empty()) {
+                tasks.push_back(Task(id, estimatedTime, std::forward<F>(taskFunc), taskClass, deadlineSeconds));
+                totalExecutionTime += estimatedTime;
+                totalTasksWaiting++;
+                added = true;
+            }
+        }
+        // Друк після звільнення замка, щоб консоль не тримала чергу
+        if (verbose) {
+            if (added) std::cout << "[TaskQueue] Task " << id << " added with estimated time: " << estimatedTime << " seconds\n";
+            else std::cout << "[TaskQueue] Rejected: task " << id << " (" << estimatedTime << " seconds)\n";
+        }
+        return added ? EnqueueResult::Added : EnqueueResult::OverBudget;
+    }
+
+    // Продовження вже прийнятої роботи: бюджет не перевіряється
+    bool addContinuation(int id, TaskFunction&& func) {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        tasks.push_back(Task(id, 0, std::move(func)));
+        return true;
+    }
+
+    bool getTask(Task& task) {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        if (tasks.empty()) return false;
+        size_t next = selectNext();
+        task = std::move(tasks.at(next));
+        tasks.removeAt(next);
+        totalExecutionTime -= task.duration;
+        return true;
+    }
+
+    void swap(TaskQueue& other) noexcept {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        std::lock_guard<std::mutex> other_lock(other.queue_mtx);
+        std::swap(tasks, other.tasks);
+        std::swap(totalExecutionTime, other.totalExecutionTime);
+    }
+
+    // Задачі знищуються вже після звільнення замка: скинута задача submit завершує свій future,
+    // і його продовження можуть знову звернутися до черг
+    void clear() {
+        TaskRing dropped;
+        {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            tasks.swap(dropped);
+            totalExecutionTime = 0;
+        }
+        if (verbose) std::cout << "[TaskQueue] Queue cleared.\n";
+    }
+
+    int getTaskCount() {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        return totalTasks;
+    }
+
+    int getTaskWaitingCount() {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        return totalTasksWaiting;
+    }
+
+    int getQueuedCount() {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        return int(tasks.size());
+    }
+
+    // Черга росте за потреби, тож takeAll завжди переносить усе
+    bool full() const {
+        return false;
+    }
+
+    // Переносить усі задачі з other у кінець цієї черги (other лишається порожньою)
+    void takeAll(TaskQueue& other) {
+        std::lock_guard<std::mutex> lock(queue_mtx);
+        std::lock_guard<std::mutex> other_lock(other.queue_mtx);
+        while (!other.tasks.empty()) {
+            tasks.push_back(std::move(other.tasks.front()));
+            other.tasks.pop_front();
+        }
+        totalExecutionTime += other.totalExecutionTime;
+        other.totalExecutionTime = 0;
+    }
+};
+
+// Обмежена безблокувальна черга з багатьма виробниками і споживачами (кільцевий буфер Вьюкова).
+// Кожна комірка має лічильник послідовності: виробник займає комірку, коли sequence == pos,
+// споживач - коли sequence == pos + 1, тож потоки синхронізуються лише CAS-ом на своїй позиції.
+// Інтерфейс той самий, що й у TaskQueue, включно з перевіркою сумарного часу проти maxTime
+class LockFreeTaskQueue {
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        std::optional<Task> task;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    alignas(64) std::atomic<int> totalExecutionTime{0};
+    std::atomic<int> maxTime;
+    std::atomic<int> totalTasks{0};
+    std::atomic<int> totalTasksWaiting{0};
+    bool verbose = true;
+
+    // Запасна черга під замком - для задач, що під час swap чи takeAll не вмістилися в кільце.
+    // Вони прийшли раніше за все, що виробники додали в кільце після них, тож воркери беруть їх першими
+    // (overflowCount дозволяє перевірити її без замка)
+    std::mutex overflowMtx;
+    std::deque<Task> overflow;
+    std::atomic<int> overflowCount{0};
+
+    // Задача конструюється прямо в комірці, тож якщо черга повна, аргументи лишаються незачепленими
+    template <typename... Args>
+    bool push(Args&&... args) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.task.emplace(std::forward<Args>(args)...);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(std::optional<Task>& out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.task);
+                    cell.task.reset();
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool popOverflow(std::optional<Task>& out) {
+        if (overflowCount.load(std::memory_order_acquire) == 0) return false;
+        std::lock_guard<std::mutex> lock(overflowMtx);
+        if (overflow.empty()) return false;
+        out = std::move(overflow.front());
+        overflow.pop_front();
+        overflowCount.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    std::vector<Task> drain() {
+        std::vector<Task> drained;
+        std::optional<Task> task;
+        while (popOverflow(task) || pop(task)) {
+            totalExecutionTime.fetch_sub(task->duration);
+            drained.push_back(std::move(*task));
+        }
+        return drained;
+    }
+
+    // Резерв часу знімається, якщо кільце заповнене; тоді task лишається у викликача
+    bool tryEnqueue(Task& task) {
+        int duration = task.duration;
+        totalExecutionTime.fetch_add(duration);
+        if (push(std::move(task))) return true;
+        totalExecutionTime.fetch_sub(duration);
+        return false;
+    }
+
+    // Повернення задачі в чергу, з якої її взяли. Запасна черга читається раніше за кільце, тож задача
+    // не опиниться позаду новіших; atFront - задача була першою в черзі і має нею лишитися
+    void restore(Task&& task, bool atFront = false) {
+        totalExecutionTime.fetch_add(task.duration);
+        std::lock_guard<std::mutex> lock(overflowMtx);
+        if (atFront) overflow.push_front(std::move(task));
+        else overflow.push_back(std::move(task));
+        overflowCount.fetch_add(1, std::memory_order_release);
+    }
+
+    // Задачі з tasks (у порядку черги origin) переходять у це кільце, доки воно не заповниться;
+    // решта повертається в origin. Після першої невдачі кільце вже не пробується, щоб не переставити задачі
+    void refill(std::vector<Task>& tasks, LockFreeTaskQueue& origin) {
+        size_t moved = 0;
+        while (moved < tasks.size() && tryEnqueue(tasks[moved])) moved++;
+        for (size_t i = moved; i < tasks.size(); ++i) origin.restore(std::move(tasks[i]));
+    }
+
+    size_t ringCount() const {
+        size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+public:
+    // capacity округлюється вгору до степеня двійки
+    explicit LockFreeTaskQueue(size_t capacity = 1024)
+        : cells(nullptr), mask([capacity] {
+              size_t size = 2;
+              while (size < capacity) size *= 2;
+              return size - 1;
+          }()), maxTime(60) {
+        cells = std::make_unique<Cell[]>(mask + 1);
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void setVerbose(bool value) {
+        verbose = value;
+    }
+
+    template <typename F>
+    EnqueueResult addTask(int id, int estimatedTime, F&& taskFunc, TaskClass taskClass = TaskClass::Batch,
+                          int deadlineSeconds = -1) {
+        totalTasks.fetch_add(1, std::memory_order_relaxed);
+
+        // Резервуємо час CAS-ом: перевірка проти maxTime і додавання відбуваються атомарно
+        int current = totalExecutionTime.load(std::memory_order_relaxed);
+        do {
+            if (estimatedTime + current > maxTime.load(std::memory_order_relaxed) && current != 0) {
+                if (verbose) std::cout << "[TaskQueue] Rejected: task " << id << " (" << estimatedTime << " seconds)\n";
+                return EnqueueResult::OverBudget;
+            }
+        } while (!totalExecutionTime.compare_exchange_weak(current, current + estimatedTime, std::memory_order_relaxed));
+
+        if (!push(id, estimatedTime, std::forward<F>(taskFunc), taskClass, deadlineSeconds)) {
+            totalExecutionTime.fetch_sub(estimatedTime, std::memory_order_relaxed);
+            if (verbose) std::cout << "[TaskQueue] Rejected: task " << id << " (queue is full)\n";
+            return EnqueueResult::Full;
+        }
+        if (verbose) std::cout << "[TaskQueue] Task " << id << " added with estimated time: " << estimatedTime << " seconds\n";
+        totalTasksWaiting.fetch_add(1, std::memory_order_relaxed);
+        return EnqueueResult::Added;
+    }
+
+    void setMaxTime(int value) {
+        maxTime.store(value, std::memory_order_relaxed);
+    }
+
+    // Бюджет не перевіряється; false лише якщо кільце заповнене - тоді func лишається у викликача
+    bool addContinuation(int id, TaskFunction&& func) {
+        return push(id, 0, std::move(func));
+    }
+
+    int getQueuedTime() {
+        return totalExecutionTime.load(std::memory_order_relaxed);
+    }
+
+    bool getTask(Task& task) {
+        std::optional<Task> popped;
+        if (!popOverflow(popped) && !pop(popped)) return false;
+        task = std::move(*popped);
+        totalExecutionTime.fetch_sub(task.duration, std::memory_order_relaxed);
+        return true;
+    }
+
+    // На відміну від TaskQueue обмін не атомарний: обидві черги вичерпуються і заповнюються навхрест.
+    // Задачі, що не вмістилися в менше кільце (або в кільце, яке встигли заповнити виробники),
+    // лишаються на початку своєї черги, тож не губиться і не переставляється жодна
+    void swap(LockFreeTaskQueue& other) {
+        std::vector<Task> mine = drain();
+        std::vector<Task> theirs = other.drain();
+        refill(theirs, other);
+        other.refill(mine, *this);
+    }
+
+    void clear() {
+        drain();
+        if (verbose) std::cout << "[TaskQueue] Queue cleared.\n";
+    }
+
+    int getTaskCount() {
+        return totalTasks.load(std::memory_order_relaxed);
+    }
+
+    int getTaskWaitingCount() {
+        return totalTasksWaiting.load(std::memory_order_relaxed);
+    }
+
+    int getQueuedCount() {
+        return int(ringCount()) + overflowCount.load(std::memory_order_relaxed);
+    }
+
+    // Кільце заповнене: takeAll нічого не перенесе, поки воркери не звільнять місце
+    bool full() const {
+        return ringCount() > mask;
+    }
+
+    // Переносить задачі з other, поки в кільці є місце; решта лишається в other до наступного виклику
+    void takeAll(LockFreeTaskQueue& other) {
+        std::optional<Task> task;
+        while (!full() && (other.popOverflow(task) || other.pop(task))) {
+            other.totalExecutionTime.fetch_sub(task->duration);
+            if (!tryEnqueue(*task)) {
+                other.restore(std::move(*task), true);
+                return;
+            }
+        }
+    }
+};
+
+enum class SchedulingMode {
+    SharedQueue,  // усі воркери беруть задачі з mainQueue під спільними замками
+    WorkStealing  // у кожного воркера власна дека; вільний воркер краде з чужих
+};
+
+enum class SwapPolicy {
+    FixedInterval, // обмін черг кожні swapInterval секунд
+    EventDriven    // перенесення буфера, щойно основна черга спорожніла або буфер досяг swapThreshold;
+                   // swapInterval - лише верхня межа очікування
+};
+
+// Що отримує виробник, коли задача не вміщується в бюджет черги
+enum class Backpressure {
+    Reject,    // задача відкидається, як і раніше
+    Block,     // addTask чекає на місце до maxBlockSeconds
+    RetryAfter // addTask одразу повертає оцінку, через скільки варто спробувати знову
+};
+
+enum class AdmissionStatus {
+    Accepted,
+    Rejected,   // не вмістилася в бюджет черги
+    RetryAfter,
+    QueueFull   // буферне кільце LockFreeTaskQueue заповнене, незалежно від бюджету
+};
+
+struct AdmissionResult {
+    AdmissionStatus status = AdmissionStatus::Accepted;
+    std::chrono::milliseconds retryAfter{0};
+
+    bool accepted() const { return status == AdmissionStatus::Accepted; }
+};
+
+struct PoolOptions {
+    SchedulingMode mode = SchedulingMode::SharedQueue;
+    SwapPolicy swapPolicy = SwapPolicy::FixedInterval;
+    int swapInterval = 40;
+    int swapThreshold = 4;
+    QueueOrdering ordering = QueueOrdering::Fifo; // лише для TaskQueue; LockFreeTaskQueue завжди FIFO
+    int agingSeconds = 20;
+    bool simulateDuration = true; // воркер спить task.duration секунд перед виконанням задачі
+    bool quiet = false;           // без виводу в консоль і metrics.log - для бенчмарків
+    std::string tracePath;        // якщо задано, події задач пишуться сюди у форматі Chrome trace
+    size_t traceCapacity = 4096;  // подій у кільці кожного воркера
+
+    // Допуск задач: без adaptiveAdmission бюджет буферної черги сталий (maxTime секунд оцінок).
+    // З ним бюджет = виміряна пропускна здатність * targetDelay, тобто стільки роботи,
+    // скільки пул розбере за цільову затримку
+    int maxTime = 60;
+    bool adaptiveAdmission = false;
+    double targetDelay = 15;
+    Backpressure backpressure = Backpressure::Reject;
+    int maxBlockSeconds = 10;
+
+    PinPolicy pinPolicy = PinPolicy::None; // воркер i закріплюється за ядром cpuForThread(pinPolicy, i)
+};
+
+// Лічильник, який змінює лише один потік: звичайні load/store без lock-префікса,
+// а читати його можна з будь-якого потоку
+inline void bump(std::atomic<long long>& counter, long long delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Гістограма затримок у мікросекундах: кошик k містить значення з [2^(k-1), 2^k)
+struct LatencyHistogram {
+    static constexpr int BUCKETS = 40;
+    std::array<std::atomic<long long>, BUCKETS> buckets{};
+
+    static int bucketOf(long long micros) {
+        return micros <= 0 ? 0 : std::min(int(std::bit_width(uint64_t(micros))), BUCKETS - 1);
+    }
+
+    void record(long long micros) {
+        bump(buckets[bucketOf(micros)]);
+    }
+};
+
+// Зведена копія гістограм кількох воркерів, з якої рахуються перцентилі
+struct HistogramSnapshot {
+    std::array<long long, LatencyHistogram::BUCKETS> counts{};
+    long long total = 0;
+
+    void add(const LatencyHistogram& histogram) {
+        for (int k = 0; k < LatencyHistogram::BUCKETS; ++k) {
+            long long count = histogram.buckets[k].load(std::memory_order_relaxed);
+            counts[k] += count;
+            total += count;
+        }
+    }
+
+    // Верхня межа кошика, у який потрапляє перцентиль, у мікросекундах
+    long long percentile(double fraction) const {
+        long long rank = (long long)(fraction * total);
+        long long seen = 0;
+        for (int k = 0; k < LatencyHistogram::BUCKETS; ++k) {
+            seen += counts[k];
+            if (seen > rank) return k == 0 ? 0 : (1LL << k) - 1;
+        }
+        return 0;
+    }
+};
+
+enum class TraceKind : uint8_t {
+    Start,
+    Finish
+};
+
+struct TraceEvent {
+    long long timestamp; // мікросекунди від створення пулу
+    long long waitMicros;
+    int taskId;
     int duration;
-    std::function<void()> func;
+    TraceKind kind;
+    TaskClass taskClass;
+};
+
+// Кільце подій з одним записувачем (воркер) і одним читачем (репортер).
+// Якщо репортер не встигає, нові події відкидаються і лише рахуються
+class TraceRing {
+private:
+    std::vector<TraceEvent> events;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    std::atomic<long long> dropped{0};
+
+    explicit TraceRing(size_t capacity) : events(std::bit_ceil(std::max<size_t>(capacity, 2))), mask(events.size() - 1) {}
+
+    void push(const TraceEvent& event) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) == events.size()) {
+            bump(dropped);
+            return;
+        }
+        events[position & mask] = event;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    template <typename F>
+    void drain(F&& consume) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        size_t end = head.load(std::memory_order_acquire);
+        for (; position != end; ++position) {
+            consume(events[position & mask]);
+        }
+        tail.store(position, std::memory_order_release);
+    }
+};
+
+// Метрики воркера пишуться лише ним самим, кожен набір - в окремих кеш-лініях.
+// Пул зводить їх лише на запит (logMetrics, reportLatency)
+struct alignas(64) WorkerMetrics {
+    std::array<std::atomic<long long>, TASK_CLASSES> started{};
+    std::array<std::atomic<long long>, TASK_CLASSES> missedDeadlines{};
+    std::atomic<long long> completed{0};
+    std::atomic<long long> completedUnits{0}; // сума duration виконаних задач
+    std::atomic<long long> busyMicros{0};
+    std::atomic<long long> waitMicros{0};
+    std::array<LatencyHistogram, TASK_CLASSES> wait;
+    LatencyHistogram run;
+    TraceRing trace;
+
+    explicit WorkerMetrics(size_t traceCapacity) : trace(traceCapacity) {}
+};
+
+struct PoolMetrics {
+    std::array<long long, TASK_CLASSES> started{};
+    std::array<long long, TASK_CLASSES> missedDeadlines{};
+    std::array<HistogramSnapshot, TASK_CLASSES> wait;
+    HistogramSnapshot run;
+    long long completed = 0;
+    long long rejected = 0;
+    long long droppedEvents = 0;
+    long long completedUnits = 0;
+    long long busyMicros = 0;
+    long long waitMicros = 0;
+};
+
+// Контролер допуску: раз на ADMISSION_PERIOD перераховує бюджет буферної черги.
+// Пропускна здатність - одиниць duration за секунду зайнятості воркера, помножене на кількість воркерів,
+// тож простій пулу оцінку не занижує. Якщо фактична затримка перевищує цільову, бюджет додатково стискається
+class AdmissionController {
+private:
+    static constexpr auto ADMISSION_PERIOD = std::chrono::milliseconds(500);
+
+    std::mutex mtx;
+    Clock::time_point lastUpdate = Clock::now();
+    long long lastUnits = 0;
+    long long lastBusyMicros = 0;
+    long long lastWaitMicros = 0;
+    long long lastStarted = 0;
+    double capacity = 0;
+    std::atomic<int> budget;
+
+public:
+    explicit AdmissionController(int initialBudget) : budget(initialBudget) {}
+
+    int getBudget() const { return budget.load(std::memory_order_relaxed); }
+    double getCapacity() { std::lock_guard<std::mutex> lock(mtx); return capacity; }
+
+    // Повертає true, якщо бюджет перераховано; queuedElsewhere - робота, що вже чекає в основній черзі
+    template <typename Collect>
+    bool update(size_t workers, double targetDelay, int queuedElsewhere, Collect&& collectMetrics) {
+        std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+        if (!lock) return false;
+        Clock::time_point now = Clock::now();
+        if (now - lastUpdate < ADMISSION_PERIOD) return false;
+        lastUpdate = now;
+
+        PoolMetrics metrics = collectMetrics();
+        long long started = 0;
+        for (long long count : metrics.started) started += count;
+        long long units = metrics.completedUnits - lastUnits;
+        long long busy = metrics.busyMicros - lastBusyMicros;
+        long long waited = metrics.waitMicros - lastWaitMicros;
+        long long startedNow = started - lastStarted;
+        lastUnits = metrics.completedUnits;
+        lastBusyMicros = metrics.busyMicros;
+        lastWaitMicros = metrics.waitMicros;
+        lastStarted = started;
+
+        if (busy > 0 && units > 0) {
+            double rate = workers * units / (busy / 1e6);
+            capacity = capacity == 0 ? rate : 0.7 * capacity + 0.3 * rate;
+        }
+        if (capacity == 0) return false;
+
+        double target = capacity * targetDelay;
+        if (startedNow > 0) {
+            double observedDelay = waited / 1e6 / startedNow;
+            if (observedDelay > targetDelay) target *= std::max(0.5, targetDelay / observedDelay);
+        }
+        budget.store(std::max(1, int(target) - queuedElsewhere), std::memory_order_relaxed);
+        return true;
+    }
+
+    // Оцінка, коли в бюджеті звільниться місце під задачу
+    std::chrono::milliseconds retryAfter(int estimatedTime, int queued) {
+        std::lock_guard<std::mutex> lock(mtx);
+        double excess = std::max(1, estimatedTime + queued - budget.load(std::memory_order_relaxed));
+        double seconds = capacity > 0 ? excess / capacity : 1.0;
+        return std::chrono::milliseconds(std::max(1LL, (long long)(seconds * 1000)));
+    }
+};
+
+// Те, на чому виконуються продовження futures: пул кладе їх одразу в робочу чергу, оминаючи бюджет допуску,
+// бо це частина вже прийнятої роботи
+class TaskExecutor {
+public:
+    virtual void post(TaskFunction task) = 0;
+
+protected:
+    ~TaskExecutor() = default;
+};
+
+class TaskRejected : public std::runtime_error {
+public:
+    TaskRejected() : std::runtime_error("task rejected by admission control") {}
+};
+
+class TaskDropped : public std::runtime_error {
+public:
+    TaskDropped() : std::runtime_error("task dropped before it ran") {}
+};
+
+// Спільний стан future: значення або виняток і колбеки, що спрацьовують у потоці, який завершив задачу
+template <typename T>
+class FutureState {
+public:
+    using Stored = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    template <typename... Args>
+    void complete(Args&&... args) {
+        std::vector<TaskFunction> ready;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            value.emplace(std::forward<Args>(args)...);
+            done = true;
+            ready.swap(callbacks);
+        }
+        cv.notify_all();
+        for (TaskFunction& callback : ready) callback();
+    }
+
+    void fail(std::exception_ptr exception) {
+        std::vector<TaskFunction> ready;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            error = exception;
+            done = true;
+            ready.swap(callbacks);
+        }
+        cv.notify_all();
+        for (TaskFunction& callback : ready) callback();
+    }
+
+    // Колбек має бути коротким: він виконується прямо в потоці, що завершив задачу
+    void onReady(TaskFunction callback) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!done) {
+                callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return done; });
+    }
+
+    bool ready() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return done;
+    }
+
+    // Після завершення стан більше не змінюється, тож читати можна без замка
+    std::exception_ptr error;
+    std::optional<Stored> value;
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+    std::vector<TaskFunction> callbacks;
+};
+
+template <typename F, typename T>
+struct ContinuationResult {
+    using type = std::invoke_result_t<F, const T&>;
+};
+
+template <typename F>
+struct ContinuationResult<F, void> {
+    using type = std::invoke_result_t<F>;
+};
+
+// Виконує func і переносить результат або виняток у state
+template <typename R, typename F>
+void runInto(FutureState<R>& state, F&& func) {
+    try {
+        if constexpr (std::is_void_v<R>) {
+            func();
+            state.complete();
+        } else {
+            state.complete(func());
+        }
+    } catch (...) {
+        state.fail(std::current_exception());
+    }
+}
+
+// Задача, що завершує свій future. Якщо її знищили, так і не виконавши (обмін у режимі FixedInterval
+// скинув невиконані задачі, пул зупинився з непорожніми чергами), future завершується винятком TaskDropped:
+// get() не висить, а колбеки продовжень, що тримають стан, звільняються
+template <typename R, typename F>
+class FutureTask {
+public:
+    FutureTask(std::shared_ptr<FutureState<R>> state, F func) : state(std::move(state)), func(std::move(func)) {}
+    FutureTask(FutureTask&&) = default;
+    FutureTask& operator=(FutureTask&&) = delete;
+
+    ~FutureTask() {
+        if (state) state->fail(std::make_exception_ptr(TaskDropped()));
+    }
+
+    void operator()() {
+        std::shared_ptr<FutureState<R>> target = std::move(state);
+        runInto(*target, func);
+    }
+
+    // Черга задачу не прийняла: future завершується причиною відмови, а не TaskDropped
+    void reject(std::exception_ptr reason) {
+        std::shared_ptr<FutureState<R>> target = std::move(state);
+        target->fail(reason);
+    }
+
+private:
+    std::shared_ptr<FutureState<R>> state;
+    F func;
+};
+
+// Легкий future задачі пулу. get() блокує, тож викликати його слід лише поза воркерами;
+// усередині графа залежності виражаються через then і whenAll
+template <typename T>
+class TaskFuture {
+public:
+    TaskFuture() = default;
+    TaskFuture(std::shared_ptr<FutureState<T>> state, TaskExecutor* executor)
+        : state(std::move(state)), executor(executor) {}
+
+    bool valid() const { return state != nullptr; }
+    bool ready() const { return state->ready(); }
+    void wait() const { state->wait(); }
+
+    T get() const {
+        state->wait();
+        if (state->error) std::rethrow_exception(state->error);
+        if constexpr (!std::is_void_v<T>) return *state->value;
+    }
+
+    // Продовження ставиться в пул, щойно цей future завершиться; жоден воркер на нього не чекає.
+    // Функція отримує const T& (або нічого для void); помилка передається далі без виклику функції
+    template <typename F>
+    auto then(F&& func) const -> TaskFuture<typename ContinuationResult<std::decay_t<F>, T>::type> {
+        using R = typename ContinuationResult<std::decay_t<F>, T>::type;
+        auto next = std::make_shared<FutureState<R>>();
+        TaskExecutor* target = executor;
+        FutureTask job(next, [source = state, func = std::forward<F>(func)]() mutable -> R {
+            if (source->error) std::rethrow_exception(source->error);
+            if constexpr (std::is_void_v<T>) {
+                return func();
+            } else {
+                return func(*source->value);
+            }
+        });
+        state->onReady([target, job = std::move(job)]() mutable { target->post(std::move(job)); });
+        return TaskFuture<R>(next, executor);
+    }
+
+    const std::shared_ptr<FutureState<T>>& shared() const { return state; }
+    TaskExecutor* getExecutor() const { return executor; }
+
+private:
+    std::shared_ptr<FutureState<T>> state;
+    TaskExecutor* executor = nullptr;
+};
+
+template <typename T>
+using WhenAllResult = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+// Злиття: завершується, коли завершилися всі вхідні futures; результати - в тому ж порядку.
+// Лічильник зменшується в колбеках, тож окремих задач на очікування не створюється
+template <typename T>
+TaskFuture<WhenAllResult<T>> whenAll(const std::vector<TaskFuture<T>>& futures, TaskExecutor* executor) {
+    auto result = std::make_shared<FutureState<WhenAllResult<T>>>();
+    if (futures.empty()) {
+        result->complete();
+        return TaskFuture<WhenAllResult<T>>(result, executor);
+    }
+
+    auto inputs = std::make_shared<std::vector<TaskFuture<T>>>(futures);
+    auto remaining = std::make_shared<std::atomic<size_t>>(futures.size());
+    for (const TaskFuture<T>& future : futures) {
+        future.shared()->onReady([result, remaining, inputs] {
+            if (remaining->fetch_sub(1) != 1) return;
+            for (const TaskFuture<T>& input : *inputs) {
+                if (input.shared()->error) {
+                    result->fail(input.shared()->error);
+                    return;
+                }
+            }
+            if constexpr (std::is_void_v<T>) {
+                result->complete();
+            } else {
+                std::vector<T> values;
+                values.reserve(inputs->size());
+                for (const TaskFuture<T>& input : *inputs) values.push_back(*input.shared()->value);
+                result->complete(std::move(values));
+            }
+        });
+    }
+    return TaskFuture<WhenAllResult<T>>(result, executor);
+}
+
+// Дека воркера в режимі крадіжки. Планувальник роздає задачі вже впорядкованими (EDF/SJF з класами),
+// тож і власник, і інші воркери, що крадуть, беруть з початку: першою виконується найтерміновіша.
+// Кожна дека в окремій кеш-лінії
+struct alignas(64) WorkerDeque {
+    std::mutex mtx;
+    std::condition_variable cv;
+    TaskRing tasks;
+    bool sleeping = false;
+};
+
+template <typename Queue = TaskQueue>
+class ThreadPool : public TaskExecutor {
+private:
+    std::vector<std::thread> workers;
+    Queue mainQueue;
+    Queue bufferQueue;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::condition_variable schedulerCv;
+    std::atomic<bool> stop;
+    std::atomic<bool> paused;
+    int swapCount = 0;
+    std::atomic<int> taskCounter{0};
+    std::atomic<int> rejectedTasks{0};
+
+    PoolOptions options;
+    std::vector<std::unique_ptr<WorkerDeque>> deques;
+    std::atomic<int> queuedTasks{0};
+    std::atomic<size_t> nextDeque{0};
+
+    Clock::time_point startTime = Clock::now();
+    std::vector<std::unique_ptr<WorkerMetrics>> workerMetrics;
+    bool recordEvents = false;
+    std::ofstream metricsLog;
+
+    // Репортер: окремий потік, що періодично забирає події з кілець воркерів,
+    // друкує їх і накопичує для трейсу. Воркери самі в консоль не пишуть
+    std::thread reporter;
+    std::mutex reporterMtx;
+    std::condition_variable reporterCv;
+    bool reporterStop = false;
+    std::vector<std::pair<size_t, TraceEvent>> traceEvents;
+
+    AdmissionController admission;
+    std::mutex admissionMtx;
+    std::condition_variable admissionCv;
+
+    static long long micros(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    void record(WorkerMetrics& metrics, TraceKind kind, const Task& task, Clock::time_point when, long long waitMicros) {
+        if (!recordEvents) return;
+        metrics.trace.push(TraceEvent{micros(when - startTime), waitMicros, task.id, task.duration, kind, task.taskClass});
+    }
+
+    void execute(size_t worker, Task& task) {
+        WorkerMetrics& metrics = *workerMetrics[worker];
+        int taskClass = int(task.taskClass);
+        Clock::time_point startedAt = Clock::now();
+        long long waitMicros = micros(startedAt - task.enqueueTime);
+        bump(metrics.started[taskClass]);
+        bump(metrics.waitMicros, waitMicros);
+        metrics.wait[taskClass].record(waitMicros);
+        record(metrics, TraceKind::Start, task, startedAt, waitMicros);
 
-    Task(int id, int duration, std::function<void()> func)
-        : id(id), duration(duration), func(std::move(func)) {}
-};
+        if (options.simulateDuration) std::this_thread::sleep_for(std::chrono::seconds(task.duration));
+        task.func();
 
-class TaskQueue {
-private:
-    std::queue<Task> tasks;
-    std::mutex queue_mtx;
-    int totalExecutionTime;
-    const int maxTime;
-    int totalTasks;
-    int totalTasksWaiting;
+        Clock::time_point finishedAt = Clock::now();
+        metrics.run.record(micros(finishedAt - startedAt));
+        bump(metrics.busyMicros, micros(finishedAt - startedAt));
+        bump(metrics.completedUnits, task.duration);
+        bump(metrics.completed);
+        if (finishedAt > task.deadline) bump(metrics.missedDeadlines[taskClass]);
+        record(metrics, TraceKind::Finish, task, finishedAt, waitMicros);
+    }
 
-public:
-    TaskQueue() : totalExecutionTime(0), maxTime(60), totalTasks(0), totalTasksWaiting(0) {}
+    void drainEvents() {
+        std::vector<std::pair<size_t, TraceEvent>> batch;
+        for (size_t worker = 0; worker < workerMetrics.size(); ++worker) {
+            workerMetrics[worker]->trace.drain([&batch, worker](const TraceEvent& event) {
+                batch.emplace_back(worker, event);
+            });
+        }
+        std::sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {
+            return a.second.timestamp < b.second.timestamp;
+        });
 
-    ~TaskQueue() {
-        clear();
+        if (!options.quiet) {
+            for (const auto& [worker, event] : batch) {
+                if (event.kind == TraceKind::Start) {
+                    std::cout << "[Worker " << worker << "] Executing task ID: " << event.taskId << " (" << event.duration << " seconds)\n";
+                } else {
+                    std::cout << "[Worker " << worker << "] Task ID: " << event.taskId << " completed.\n";
+                }
+            }
+        }
+        if (!options.tracePath.empty()) {
+            traceEvents.insert(traceEvents.end(), batch.begin(), batch.end());
+        }
     }
 
-    bool addTask(int id, int estimatedTime, const std::function<void()>& taskFunc) {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        totalTasks++;
-        if (estimatedTime + totalExecutionTime > maxTime) {
-            std::cout << "[TaskQueue] Rejected: task " << id << " (" << estimatedTime << " seconds)\n";
-            return false;
-        }
-        tasks.emplace(id, estimatedTime, taskFunc);
-        totalExecutionTime += estimatedTime;
-        std::cout << "[TaskQueue] Task " << id << " added with estimated time: " << estimatedTime << " seconds\n";
-        totalTasksWaiting++;
-        return true;
+    void reporterLoop() {
+        std::unique_lock<std::mutex> lock(reporterMtx);
+        while (!reporterStop) {
+            reporterCv.wait_for(lock, std::chrono::milliseconds(50), [this] { return reporterStop; });
+            drainEvents();
+        }
+        drainEvents();
     }
 
-    bool getTask(Task& task) {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        if (tasks.empty()) return false;
-        task = tasks.front();
-        tasks.pop();
-        totalExecutionTime -= task.duration;
-        return true;
+    void writeTrace() {
+        std::ofstream out(options.tracePath);
+        if (!out) {
+            std::cerr << "Cannot write trace to " << options.tracePath << "\n";
+            return;
+        }
+        out << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < traceEvents.size(); ++i) {
+            const auto& [worker, event] = traceEvents[i];
+            out << "{\"name\":\"task " << event.taskId << "\",\"cat\":\"" << taskClassName(event.taskClass)
+                << "\",\"ph\":\"" << (event.kind == TraceKind::Start ? 'B' : 'E')
+                << "\",\"ts\":" << event.timestamp << ",\"pid\":1,\"tid\":" << worker;
+            if (event.kind == TraceKind::Start) {
+                out << ",\"args\":{\"wait_us\":" << event.waitMicros << ",\"duration\":" << event.duration << "}";
+            }
+            out << "}" << (i + 1 < traceEvents.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
     }
 
-    void swap(TaskQueue& other) noexcept {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        std::lock_guard<std::mutex> other_lock(other.queue_mtx);
-        std::swap(tasks, other.tasks);
-        std::swap(totalExecutionTime, other.totalExecutionTime);
+    void sharedQueueLoop(size_t i) {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this, &task] {
+                    if (stop) return true;
+                    if (paused) return false;
+                    if (mainQueue.getTask(task)) return true;
+                    if (options.swapPolicy == SwapPolicy::EventDriven) schedulerCv.notify_one();
+                    return false;
+                });
+                if (stop) return;
+            }
+            execute(i, task);
+        }
     }
 
-    void clear() {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        std::queue<Task>().swap(tasks);
-        totalExecutionTime = 0;
-        std::cout << "[TaskQueue] Queue cleared.\n";
+    // Будимо саме того воркера, якому дісталася задача; якщо він зайнятий - одного сплячого,
+    // щоб той її вкрав. notify_all на всіх воркерів більше не потрібен
+    void wakeFor(size_t owner) {
+        size_t count = deques.size();
+        for (size_t k = 0; k < count; ++k) {
+            WorkerDeque& d = *deques[(owner + k) % count];
+            std::lock_guard<std::mutex> lock(d.mtx);
+            if (d.sleeping) {
+                d.cv.notify_one();
+                return;
+            }
+        }
     }
 
-    int getTaskCount() {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        return totalTasks;
+    void wakeAll() {
+        for (auto& d : deques) {
+            std::lock_guard<std::mutex> lock(d->mtx);
+            d->cv.notify_all();
+        }
     }
 
-    int getTaskWaitingCount() {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        return totalTasksWaiting;
+    void dispatch(Task task) {
+        size_t owner = nextDeque.fetch_add(1) % deques.size();
+        {
+            std::lock_guard<std::mutex> lock(deques[owner]->mtx);
+            deques[owner]->tasks.push_back(std::move(task));
+        }
+        queuedTasks.fetch_add(1);
+        wakeFor(owner);
     }
-};
 
-class ThreadPool {
-private:
-    std::vector<std::thread> workers;
-    TaskQueue mainQueue;
-    TaskQueue bufferQueue;
-    std::mutex mtx;
-    std::condition_variable cv;
-    bool stop;
-    bool paused;
-    int swapCount = 0;
-    int taskCounter = 0;
-    std::atomic<int> completedTasks{0};
-    std::atomic<int> rejectedTasks{0};
+    bool takeTask(size_t i, Task& task) {
+        if (paused) return false;
+        {
+            WorkerDeque& own = *deques[i];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.front());
+                own.tasks.pop_front();
+                queuedTasks.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t k = 1; k < deques.size(); ++k) {
+            WorkerDeque& victim = *deques[(i + k) % deques.size()];
+            std::lock_guard<std::mutex> lock(victim.mtx);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queuedTasks.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workStealingLoop(size_t i) {
+        WorkerDeque& own = *deques[i];
+        while (true) {
+            Task task;
+            if (takeTask(i, task)) {
+                // Лишилася робота - даємо її шанс сплячому сусідові
+                if (queuedTasks.load() > 0) wakeFor(i + 1);
+                execute(i, task);
+                continue;
+            }
+
+            if (options.swapPolicy == SwapPolicy::EventDriven) notifyScheduler();
+
+            std::unique_lock<std::mutex> lock(own.mtx);
+            own.sleeping = true;
+            own.cv.wait(lock, [this] { return stop || (!paused && queuedTasks.load() > 0); });
+            own.sleeping = false;
+            if (stop) return;
+        }
+    }
+
+    void updateBudget() {
+        if (!options.adaptiveAdmission) return;
+        bool updated = admission.update(workers.size(), options.targetDelay, mainQueue.getQueuedTime(),
+                                        [this] { return collectMetrics(); });
+        if (updated) {
+            bufferQueue.setMaxTime(admission.getBudget());
+            notifyProducers();
+        }
+    }
+
+    void notifyProducers() {
+        if (options.backpressure != Backpressure::Block) return;
+        { std::lock_guard<std::mutex> lock(admissionMtx); }
+        admissionCv.notify_all();
+    }
+
+    // Задачі, яких зупинений пул уже не виконає: їхні futures завершуються TaskDropped
+    void dropPending() {
+        if (mainQueue.getQueuedCount() > 0) mainQueue.clear();
+        if (bufferQueue.getQueuedCount() > 0) bufferQueue.clear();
+        for (auto& d : deques) {
+            TaskRing dropped;
+            {
+                std::lock_guard<std::mutex> lock(d->mtx);
+                d->tasks.swap(dropped);
+            }
+            queuedTasks.fetch_sub(int(dropped.size()));
+        }
+    }
+
+    bool mainQueueIdle() {
+        return mainQueue.getQueuedCount() == 0 && queuedTasks.load() == 0;
+    }
+
+    // Поки основна черга заповнена, перенесення чекає: інакше планувальник крутився б, нічого не переносячи
+    bool swapDue() {
+        int buffered = bufferQueue.getQueuedCount();
+        return buffered > 0 && !mainQueue.full() && (buffered >= options.swapThreshold || mainQueueIdle());
+    }
+
+    // Короткий захват mtx гарантує, що планувальник або вже чекає, або ще не перевірив умову
+    void notifyScheduler() {
+        { std::lock_guard<std::mutex> lock(mtx); }
+        schedulerCv.notify_one();
+    }
 
 public:
-    explicit ThreadPool(size_t numThreads) : stop(false), paused(false) {
+    explicit ThreadPool(size_t numThreads, PoolOptions options = PoolOptions())
+        : stop(false), paused(false), options(options), admission(options.maxTime) {
+        mainQueue.setMaxTime(options.maxTime);
+        bufferQueue.setMaxTime(options.maxTime);
+        if constexpr (std::is_same_v<Queue, TaskQueue>) {
+            mainQueue.setOrdering(options.ordering, options.agingSeconds);
+            bufferQueue.setOrdering(options.ordering, options.agingSeconds);
+        }
+        mainQueue.setVerbose(!options.quiet);
+        bufferQueue.setVerbose(!options.quiet);
+        if (!options.quiet) metricsLog.open("metrics.log", std::ios::app);
+
+        for (size_t i = 0; i < numThreads; ++i) {
+            workerMetrics.push_back(std::make_unique<WorkerMetrics>(options.traceCapacity));
+        }
+        recordEvents = !options.quiet || !options.tracePath.empty();
+        if (recordEvents) reporter = std::thread(&ThreadPool::reporterLoop, this);
+        if (options.mode == SchedulingMode::WorkStealing) {
+            for (size_t i = 0; i < numThreads; ++i) {
+                deques.push_back(std::make_unique<WorkerDeque>());
+            }
+        }
         for (size_t i = 0; i < numThreads; ++i) {
             workers.emplace_back([this, i] {
-                while (true) {
-                    Task task(0, 0, []{});
-                    {
-                        std::unique_lock<std::mutex> lock(mtx);
-                        cv.wait(lock, [this, &task] { return stop || (!paused && mainQueue.getTask(task)); });
-                        if (stop) return;
-                    }
-                    {
-                        std::lock_guard<std::mutex> lock(mtx);
-                        std::cout << "[Worker " << i << "] Executing task ID: " << task.id << " (" << task.duration << " seconds)\n";
-
-                    }
-
-                    std::this_thread::sleep_for(std::chrono::seconds(task.duration));
-                    completedTasks.fetch_add(1);
-                    task.func();
-                    {
-                        std::lock_guard<std::mutex> lock(mtx);
-                        std::cout << "[Worker " << i << "] Task ID: " << task.id << " completed.\n";
-                    }
+                pinCurrentThread(this->options.pinPolicy, int(i));
+                if (this->options.mode == SchedulingMode::WorkStealing) {
+                    workStealingLoop(i);
+                } else {
+                    sharedQueueLoop(i);
                 }
             });
         }
@@ -129,31 +1425,113 @@ public:
 
     void scheduleExecution() {
         while (!stop) {
-            std::this_thread::sleep_for(std::chrono::seconds(40));
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (paused) continue;
-                std::cout << "[Scheduler] Swapping queues and notifying workers.\n";
-                mainQueue.swap(bufferQueue);
-                bufferQueue.clear();
+            if (options.swapPolicy == SwapPolicy::EventDriven) {
+                std::unique_lock<std::mutex> lock(mtx);
+                schedulerCv.wait_for(lock, std::chrono::seconds(options.swapInterval),
+                                     [this] { return stop || (!paused && swapDue()); });
+                if (stop) break;
+                if (paused || bufferQueue.getQueuedCount() == 0) continue;
+                if (!options.quiet) std::cout << "[Scheduler] Moving buffered tasks to the main queue.\n";
+                mainQueue.takeAll(bufferQueue);
                 swapCount++;
+            } else {
+                std::this_thread::sleep_for(std::chrono::seconds(options.swapInterval));
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (paused) continue;
+                    if (!options.quiet) std::cout << "[Scheduler] Swapping queues and notifying workers.\n";
+                    mainQueue.swap(bufferQueue);
+                    swapCount++;
+                }
+                // Невиконані задачі попереднього інтервалу скидаються. Без mtx: futures скинутих задач
+                // завершуються TaskDropped, а їхні продовження ставляться в пул через post
+                bufferQueue.clear();
             }
 
-            logMetrics();
-            cv.notify_all();
+            if (!options.quiet) logMetrics();
+            notifyProducers();
+            if (options.mode == SchedulingMode::WorkStealing) {
+                Task task;
+                while (mainQueue.getTask(task)) {
+                    dispatch(std::move(task));
+                }
+            } else {
+                cv.notify_all();
+            }
         }
     }
 
-    void addTask(int estimatedTime, const std::function<void()>& taskFunc) {
-        int taskId;
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            taskId = taskCounter++;
+    template <typename F>
+    AdmissionResult addTask(int estimatedTime, F&& taskFunc, TaskClass taskClass = TaskClass::Batch,
+                            int deadlineSeconds = -1) {
+        int taskId = taskCounter.fetch_add(1);
+        updateBudget();
+
+        // Черги переміщують функцію лише тоді, коли задачу прийнято, тож повторна спроба безпечна
+        auto tryAdd = [&] {
+            return bufferQueue.addTask(taskId, estimatedTime, std::forward<F>(taskFunc), taskClass, deadlineSeconds);
+        };
+        EnqueueResult enqueued = tryAdd();
+        if (enqueued != EnqueueResult::Added && options.backpressure == Backpressure::Block) {
+            // Очікування обмежене 50 мс, тож пропущене сповіщення лише трохи затримує повтор
+            auto giveUp = Clock::now() + std::chrono::seconds(options.maxBlockSeconds);
+            while (enqueued != EnqueueResult::Added && !stop && Clock::now() < giveUp) {
+                {
+                    std::unique_lock<std::mutex> lock(admissionMtx);
+                    admissionCv.wait_for(lock, std::chrono::milliseconds(50));
+                }
+                updateBudget();
+                enqueued = tryAdd();
+            }
+        }
+
+        if (enqueued == EnqueueResult::Added) {
+            if (options.swapPolicy == SwapPolicy::EventDriven && swapDue()) notifyScheduler();
+            return AdmissionResult{};
+        }
+        rejectedTasks.fetch_add(1);
+        if (enqueued == EnqueueResult::Full) return AdmissionResult{AdmissionStatus::QueueFull};
+        if (options.backpressure == Backpressure::RetryAfter) {
+            return AdmissionResult{AdmissionStatus::RetryAfter,
+                                   admission.retryAfter(estimatedTime, bufferQueue.getQueuedTime())};
         }
-        bool added = bufferQueue.addTask(taskId, estimatedTime, taskFunc);
-        if (!added) {
-            rejectedTasks.fetch_add(1);
+        return AdmissionResult{AdmissionStatus::Rejected};
+    }
+
+    // Як addTask, але повертає future результату func. Відхилена задача завершує future винятком TaskRejected,
+    // скинута до виконання (обмін у режимі FixedInterval, зупинка пулу) - винятком TaskDropped
+    template <typename F>
+    auto submit(int estimatedTime, F&& func, TaskClass taskClass = TaskClass::Batch, int deadlineSeconds = -1)
+        -> TaskFuture<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        auto state = std::make_shared<FutureState<R>>();
+        FutureTask task(state, std::decay_t<F>(std::forward<F>(func)));
+        AdmissionResult result = addTask(estimatedTime, std::move(task), taskClass, deadlineSeconds);
+        if (!result.accepted()) task.reject(std::make_exception_ptr(TaskRejected()));
+        return TaskFuture<R>(state, this);
+    }
+
+    template <typename T>
+    TaskFuture<WhenAllResult<T>> whenAll(const std::vector<TaskFuture<T>>& futures) {
+        return ::whenAll(futures, this);
+    }
+
+    // Продовження йдуть одразу в основну чергу (або деку воркера), минаючи буфер і бюджет.
+    // Якщо безблокувальна черга заповнена, продовження виконується на місці, а не чекає.
+    // Зупинений пул продовження не приймає: воно знищується, і його future завершується TaskDropped
+    void post(TaskFunction task) override {
+        if (stop) return;
+        int taskId = taskCounter.fetch_add(1);
+        if (options.mode == SchedulingMode::WorkStealing) {
+            dispatch(Task(taskId, 0, std::move(task)));
+            return;
         }
+        if (!mainQueue.addContinuation(taskId, std::move(task))) {
+            task();
+            return;
+        }
+        { std::lock_guard<std::mutex> lock(mtx); }
+        cv.notify_one();
     }
 
     void pause() {
@@ -162,9 +1540,12 @@ public:
     }
 
     void resume() {
-        std::lock_guard<std::mutex> lock(mtx);
-        paused = false;
-        cv.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            paused = false;
+            cv.notify_all();
+        }
+        wakeAll();
     }
 
     void shutdown() {
@@ -173,51 +1554,445 @@ public:
             stop = true;
         }
         cv.notify_all();
+        schedulerCv.notify_all();
+        wakeAll();
+        dropPending();
+    }
+
+    PoolMetrics collectMetrics() {
+        PoolMetrics total;
+        for (const auto& metrics : workerMetrics) {
+            for (int c = 0; c < TASK_CLASSES; ++c) {
+                total.started[c] += metrics->started[c].load(std::memory_order_relaxed);
+                total.missedDeadlines[c] += metrics->missedDeadlines[c].load(std::memory_order_relaxed);
+                total.wait[c].add(metrics->wait[c]);
+            }
+            total.run.add(metrics->run);
+            total.completed += metrics->completed.load(std::memory_order_relaxed);
+            total.completedUnits += metrics->completedUnits.load(std::memory_order_relaxed);
+            total.busyMicros += metrics->busyMicros.load(std::memory_order_relaxed);
+            total.waitMicros += metrics->waitMicros.load(std::memory_order_relaxed);
+            total.droppedEvents += metrics->trace.dropped.load(std::memory_order_relaxed);
+        }
+        total.rejected = rejectedTasks.load();
+        return total;
     }
 
+    // Файл відкривається один раз; замість ctime - секунди від створення пулу
     void logMetrics() {
-        std::ofstream logFile("metrics.log", std::ios::app);
-        if (!logFile) return;
+        if (!metricsLog) return;
+        PoolMetrics metrics = collectMetrics();
+        metricsLog << "Time: +" << micros(Clock::now() - startTime) / 1000000 << " s"
+                   << " | Swap: " << swapCount
+                   << " | Admission budget: " << (options.adaptiveAdmission ? admission.getBudget() : options.maxTime)
+                   << " | Total Tasks: " << bufferQueue.getTaskCount() + mainQueue.getTaskCount()
+                   << " | Rejected Tasks: " << metrics.rejected
+                   << " | Tasks that must be completed: " << bufferQueue.getTaskWaitingCount() + mainQueue.getTaskWaitingCount()
+                   << " | Completed Tasks: " << metrics.completed << "\n";
+        reportLatency(metricsLog, metrics);
+        metricsLog.flush();
+    }
+
+    void reportLatency(std::ostream& out) {
+        reportLatency(out, collectMetrics());
+    }
 
-        std::time_t now = std::time(nullptr);
-        logFile << "Time: " << std::ctime(&now)
-                << "Swap: " << swapCount
-                << " | Total Tasks: " << bufferQueue.getTaskCount() + mainQueue.getTaskCount()
-                << " | Rejected Tasks: " << rejectedTasks.load()
-                << " | Tasks that must be completed: " << bufferQueue.getTaskWaitingCount() + mainQueue.getTaskWaitingCount()
-                << " | Completed Tasks: " << completedTasks.load() << "\n";
-        logFile.close();
+    // Перцентилі - верхні межі кошиків гістограми, тобто оцінка зверху з точністю до 2x
+    void reportLatency(std::ostream& out, const PoolMetrics& metrics) {
+        for (int c = 0; c < TASK_CLASSES; ++c) {
+            const HistogramSnapshot& wait = metrics.wait[c];
+            out << "  " << std::setw(11) << taskClassName(TaskClass(c))
+                << " | started: " << metrics.started[c]
+                << " | wait p50/p95/p99: " << wait.percentile(0.50) / 1000 << "/" << wait.percentile(0.95) / 1000
+                << "/" << wait.percentile(0.99) / 1000 << " ms"
+                << " | missed deadlines: " << metrics.missedDeadlines[c] << "\n";
+        }
+        out << "  " << std::setw(11) << "all"
+            << " | completed: " << metrics.completed
+            << " | rejected: " << metrics.rejected
+            << " | run p50/p95/p99: " << metrics.run.percentile(0.50) / 1000 << "/" << metrics.run.percentile(0.95) / 1000
+            << "/" << metrics.run.percentile(0.99) / 1000 << " ms";
+        if (metrics.droppedEvents > 0) out << " | dropped trace events: " << metrics.droppedEvents;
+        out << "\n";
     }
 
     ~ThreadPool() {
         shutdown();
+        notifyProducers();
         for (std::thread &worker : workers) {
             worker.join();
         }
+        // Задачі, які планувальник встиг роздати вже після shutdown
+        dropPending();
+        if (reporter.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(reporterMtx);
+                reporterStop = true;
+            }
+            reporterCv.notify_all();
+            reporter.join();
+        }
+        if (!options.tracePath.empty()) writeTrace();
     }
 };
 
-void addTasksFromThread(ThreadPool &pool, int numTasks) {
+// Інтерактивні задачі короткі й мають дедлайн, пакетні - довгі й без нього
+template <typename Queue>
+void addTasksFromThread(ThreadPool<Queue> &pool, int numTasks, TaskClass taskClass) {
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(6, 14);
+    bool interactive = taskClass == TaskClass::Interactive;
+    std::uniform_int_distribution<> dist(interactive ? 1 : 6, interactive ? 4 : 14);
 
     for (int i = 0; i < numTasks; ++i) {
         int execTime = dist(gen);
-        pool.addTask(execTime, [execTime]() {
+        auto work = [execTime]() {
             std::this_thread::sleep_for(std::chrono::seconds(execTime));
-        });
+        };
+        // На RetryAfter виробник робить кілька повторних спроб, поки пул не розбере чергу
+        AdmissionResult result = pool.addTask(execTime, work, taskClass, interactive ? 3 * execTime : -1);
+        for (int retry = 0; retry < 3 && result.status == AdmissionStatus::RetryAfter; ++retry) {
+            std::this_thread::sleep_for(result.retryAfter);
+            result = pool.addTask(execTime, work, taskClass, interactive ? 3 * execTime : -1);
+        }
         std::this_thread::sleep_for(std::chrono::seconds(2));
     }
 }
 
-int main() {
-    ThreadPool pool(4);
-    std::thread scheduler(&ThreadPool::scheduleExecution, &pool);
+// Мікробенчмарк черг: кожен потік по черзі додає і забирає задачу, тож виробники
+// і споживачі постійно конкурують за ту саму чергу. Результат - мільйони операцій за секунду
+template <typename Queue>
+double measureQueueThroughput(int numThreads, int pairsPerThread) {
+    Queue queue;
+    queue.setVerbose(false);
+    auto noop = []{};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&] {
+            Task task;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int k = 0; k < pairsPerThread; ++k) {
+                while (queue.addTask(k, 0, noop) != EnqueueResult::Added) std::this_thread::yield();
+                while (!queue.getTask(task)) std::this_thread::yield();
+            }
+        });
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return 2.0 * numThreads * pairsPerThread / seconds / 1e6;
+}
+
+void benchmarkQueues() {
+    const int totalPairs = 1 << 20;
+    std::cout << "threads  mutex_Mops  lockfree_Mops\n";
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        int pairsPerThread = totalPairs / threads;
+        double mutexRate = measureQueueThroughput<TaskQueue>(threads, pairsPerThread);
+        double lockFreeRate = measureQueueThroughput<LockFreeTaskQueue>(threads, pairsPerThread);
+        std::cout << std::setw(7) << threads << std::setw(12) << mutexRate << std::setw(15) << lockFreeRate << "\n";
+    }
+}
+
+// Порівняння кількості виділень пам'яті на задачу: колишнє представлення (std::function у std::queue,
+// копіювання при вийманні) проти TaskFunction у TaskRing. Замикання типової задачі - кілька значень і вказівник
+void benchmarkAllocations() {
+#ifndef LAB3_COUNT_ALLOCATIONS
+    std::cout << "Allocation counting is compiled out; rebuild with -DLAB3_COUNT_ALLOCATIONS\n";
+#else
+    struct LegacyTask {
+        int id;
+        int duration;
+        std::function<void()> func;
+    };
+
+    const int tasks = 100000;
+    long long checksum = 0;
+    auto makeTask = [&checksum](int i) {
+        long long a = i, b = i * 2, c = i * 3;
+        return [&checksum, a, b, c] { checksum += a + b + c; };
+    };
+
+    std::queue<LegacyTask> legacyQueue;
+    long long before = allocationCount.load();
+    for (int i = 0; i < tasks; ++i) {
+        legacyQueue.push(LegacyTask{i, 0, makeTask(i)});
+        LegacyTask task = legacyQueue.front();
+        legacyQueue.pop();
+        task.func();
+    }
+    double legacyPerTask = double(allocationCount.load() - before) / tasks;
+
+    TaskQueue queue;
+    queue.setVerbose(false);
+    Task task;
+    queue.addTask(0, 0, makeTask(0));
+    queue.getTask(task);
+    before = allocationCount.load();
+    for (int i = 0; i < tasks; ++i) {
+        queue.addTask(i, 0, makeTask(i));
+        queue.getTask(task);
+        task.func();
+    }
+    double pooledPerTask = double(allocationCount.load() - before) / tasks;
+
+    std::cout << "Allocations per task (enqueue + dequeue + execute):\n"
+              << "  std::function + std::queue: " << legacyPerTask << "\n"
+              << "  TaskFunction + TaskRing:    " << pooledPerTask << "\n"
+              << "(checksum " << checksum << ")\n";
+#endif
+}
+
+// Справжні обчислювальні задачі для --bench-cpu замість сну: дзеркалення матриці відносно
+// побічної діагоналі (обмін пар тайлів, як у lab1) і пошук кратних 17 (як у lab2).
+// Буфери thread_local, тож у гарячому циклі пам'ять не виділяється
+enum class BenchKernel {
+    Mirror,
+    Scan,
+    Mixed
+};
+
+struct CpuBenchSettings {
+    std::vector<int> workers{1, 2, 4, 8};
+    std::vector<int> producers{1, 4};
+    int tasks = 20000;
+    double rate = 5000; // задач за секунду від усіх виробників разом; 0 - без обмеження
+    BenchKernel kernel = BenchKernel::Mixed;
+    int matrixSize = 128;
+    int scanSize = 16384;
+};
+
+const int BENCH_TILE = 32;
+
+long long mirrorKernel(int size, uint64_t seed) {
+    thread_local std::vector<int> matrix;
+    matrix.resize(size_t(size) * size);
+    fillBoundedRandom(matrix.data(), matrix.size(), seed, 0, 0, 99);
+    mirrorTilePairs(matrix.data(), size, 0, tileWeight(size, BENCH_TILE), BENCH_TILE);
+    return matrix[0];
+}
+
+long long scanKernel(int size, uint64_t seed) {
+    thread_local std::vector<int> numbers;
+    numbers.resize(size);
+    fillBoundedRandom(numbers.data(), numbers.size(), seed, 0, 0, 10000);
+    return filterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(numbers.data(), 0, numbers.size()).count;
+}
+
+struct CpuBenchState {
+    const CpuBenchSettings* settings;
+    std::vector<long long> waitMicros;
+    std::atomic<int> finished{0};
+    std::atomic<long long> checksum{0};
+};
+
+long long percentile(std::vector<long long>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = std::min(sorted.size() - 1, size_t(fraction * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+const int BENCH_STALL_SECONDS = 10; // Без жодної завершеної задачі так довго - задачі загубилися
+
+// Відкритий цикл: виробники додають задачі з рівномірним інтервалом незалежно від того,
+// чи встигає пул, тож затримка в черзі показує, де пул перестає тягнути навантаження.
+// rejected - відмови допуску за бюджетом, queue_full - відмови через заповнене кільце LockFreeTaskQueue.
+// false - якщо частина прийнятих задач так і не виконалася
+template <typename Queue>
+bool runCpuBenchmark(const CpuBenchSettings& settings, PoolOptions options) {
+    options.simulateDuration = false;
+    options.quiet = true;
+    options.swapPolicy = SwapPolicy::EventDriven;
+    options.swapThreshold = 1;
+
+    bool complete = true;
+    std::cout << "workers  producers  tasks/s     p50_us    p95_us    p99_us    max_us  rejected  queue_full\n";
+    for (int workers : settings.workers) {
+        for (int producers : settings.producers) {
+            CpuBenchState state;
+            state.settings = &settings;
+            state.waitMicros.assign(settings.tasks, -1);
+            std::atomic<int> rejected{0};
+            std::atomic<int> queueFull{0};
+
+            ThreadPool<Queue> pool(workers, options);
+            std::thread scheduler(&ThreadPool<Queue>::scheduleExecution, &pool);
+
+            auto startTime = Clock::now();
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; ++p) {
+                threads.emplace_back([&, p] {
+                    auto interval = std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(settings.rate > 0 ? producers / settings.rate : 0.0));
+                    auto next = Clock::now();
+                    for (int index = p; index < settings.tasks; index += producers) {
+                        if (settings.rate > 0) {
+                            std::this_thread::sleep_until(next);
+                            next += interval;
+                        }
+                        CpuBenchState* shared = &state;
+                        Clock::time_point submitted = Clock::now();
+                        AdmissionStatus status = pool.addTask(0, [shared, index, submitted] {
+                            shared->waitMicros[index] = std::chrono::duration_cast<std::chrono::microseconds>(
+                                Clock::now() - submitted).count();
+                            const CpuBenchSettings& s = *shared->settings;
+                            bool mirror = s.kernel == BenchKernel::Mirror ||
+                                          (s.kernel == BenchKernel::Mixed && index % 2 == 0);
+                            long long result = mirror ? mirrorKernel(s.matrixSize, index) : scanKernel(s.scanSize, index);
+                            shared->checksum.fetch_add(result, std::memory_order_relaxed);
+                            shared->finished.fetch_add(1, std::memory_order_release);
+                        }).status;
+                        if (status == AdmissionStatus::QueueFull) queueFull.fetch_add(1);
+                        else if (status != AdmissionStatus::Accepted) rejected.fetch_add(1);
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+            int lastFinished = -1;
+            auto lastProgress = Clock::now();
+            while (state.finished.load(std::memory_order_acquire) + rejected.load() + queueFull.load() < settings.tasks) {
+                int finished = state.finished.load(std::memory_order_acquire);
+                if (finished != lastFinished) {
+                    lastFinished = finished;
+                    lastProgress = Clock::now();
+                } else if (Clock::now() - lastProgress > std::chrono::seconds(BENCH_STALL_SECONDS)) {
+                    std::cerr << "[Bench] No progress for " << BENCH_STALL_SECONDS << " s: "
+                              << settings.tasks - finished - rejected.load() - queueFull.load()
+                              << " accepted tasks never ran\n";
+                    complete = false;
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+            pool.shutdown();
+            scheduler.join();
+
+            std::vector<long long> waits;
+            for (long long wait : state.waitMicros) {
+                if (wait >= 0) waits.push_back(wait);
+            }
+            std::sort(waits.begin(), waits.end());
+            std::cout << std::setw(7) << workers << std::setw(11) << producers
+                      << std::setw(9) << int(state.finished.load() / seconds)
+                      << std::setw(11) << percentile(waits, 0.50) << std::setw(10) << percentile(waits, 0.95)
+                      << std::setw(10) << percentile(waits, 0.99) << std::setw(10) << (waits.empty() ? 0 : waits.back())
+                      << std::setw(10) << rejected.load() << std::setw(12) << queueFull.load() << "\n";
+        }
+    }
+    return complete;
+}
+
+// Конвеєри lab1 і lab2 як графи задач на одному пулі: заповнення матриці блоками рядків -> whenAll ->
+// дзеркалення частинами за вагою пар тайлів -> whenAll -> перевірка; паралельно генерація і пошук
+// кратних 17 фрагментами -> whenAll -> злиття часткових результатів. Головний потік лише чекає на кінці графів
+template <typename Queue>
+void runGraphDemo(PoolOptions options, int workers, int matrixSize, long long scanSize) {
+    options.simulateDuration = false;
+    options.quiet = true;
+    options.swapPolicy = SwapPolicy::EventDriven;
+    options.swapThreshold = 1;
+    ThreadPool<Queue> pool(workers, options);
+    std::thread scheduler(&ThreadPool<Queue>::scheduleExecution, &pool);
+
+    const int parts = workers * 4;
+    const uint64_t seed = 2024;
+    auto startTime = Clock::now();
+
+    auto matrix = std::make_shared<FirstTouchVector<int>>(size_t(matrixSize) * matrixSize);
+    std::vector<TaskFuture<void>> fills;
+    for (int p = 0; p < parts; ++p) {
+        int firstRow = int(1LL * matrixSize * p / parts);
+        int lastRow = int(1LL * matrixSize * (p + 1) / parts);
+        fills.push_back(pool.submit(0, [matrix, matrixSize, firstRow, lastRow, seed] {
+            size_t first = size_t(firstRow) * matrixSize;
+            fillBoundedRandom(matrix->data() + first, size_t(lastRow - firstRow) * matrixSize, seed, first, 0, 99);
+        }));
+    }
+
+    TaskFuture<void> filled = pool.whenAll(fills);
+    long long totalWeight = tileWeight(matrixSize, BENCH_TILE);
+    std::vector<TaskFuture<void>> mirrors;
+    for (int p = 0; p < parts; ++p) {
+        long long firstWeight = totalWeight * p / parts;
+        long long lastWeight = totalWeight * (p + 1) / parts;
+        mirrors.push_back(filled.then([matrix, matrixSize, firstWeight, lastWeight] {
+            mirrorTilePairs(matrix->data(), matrixSize, firstWeight, lastWeight, BENCH_TILE);
+        }));
+    }
+
+    // Після дзеркалення елемент (i, j) має дорівнювати початковому (n-1-j, n-1-i)
+    TaskFuture<bool> mirrorChecked = pool.whenAll(mirrors).then([matrix, matrixSize, seed] {
+        for (int i = 0; i < matrixSize; ++i) {
+            for (int j = 0; j < matrixSize; ++j) {
+                size_t source = size_t(matrixSize - 1 - j) * matrixSize + (matrixSize - 1 - i);
+                int expected = int(boundedRandom(seed, source, 100));
+                if ((*matrix)[size_t(i) * matrixSize + j] != expected) return false;
+            }
+        }
+        return true;
+    });
+
+    using ScanResult = FilterReduceResult<CountAggregate, MinAggregate>;
+    std::vector<TaskFuture<ScanResult>> scans;
+    for (int p = 0; p < parts; ++p) {
+        long long first = scanSize * p / parts;
+        long long last = scanSize * (p + 1) / parts;
+        scans.push_back(pool.submit(0, [first, last, seed] {
+            const long long BLOCK = 4096;
+            int block[BLOCK];
+            ScanResult local;
+            for (long long start = first; start < last; start += BLOCK) {
+                size_t count = size_t(std::min(BLOCK, last - start));
+                fillBoundedRandom(block, count, seed, start, 0, 10000);
+                local.merge(filterReduce<DivisibleBy<17>, CountAggregate, MinAggregate>(block, 0, count));
+            }
+            return local;
+        }));
+    }
+    TaskFuture<ScanResult> scanned = pool.whenAll(scans).then([](const std::vector<ScanResult>& partials) {
+        ScanResult total;
+        for (const ScanResult& partial : partials) total.merge(partial);
+        return total;
+    });
+
+    bool mirrorOk = mirrorChecked.get();
+    ScanResult scan = scanned.get();
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    std::cout << "Mirror " << matrixSize << "x" << matrixSize << ": " << (mirrorOk ? "ok" : "MISMATCH") << "\n"
+              << "Multiples of 17 among " << scanSize << " numbers: " << scan.count
+              << ", minimum: " << (scan.has_min ? scan.min_element : -1) << "\n"
+              << "Both graphs finished in " << seconds * 1000 << " ms on " << workers << " workers\n";
+
+    pool.shutdown();
+    scheduler.join();
+}
+
+template <typename Queue>
+void runDemo(PoolOptions options) {
+    ThreadPool<Queue> pool(4, options);
+    std::thread scheduler(&ThreadPool<Queue>::scheduleExecution, &pool);
 
     std::vector<std::thread> adders;
     for (int i = 0; i < 3; ++i) {
-        adders.emplace_back(addTasksFromThread, std::ref(pool), 100);
+        TaskClass taskClass = i == 0 ? TaskClass::Interactive : TaskClass::Batch;
+        adders.emplace_back(addTasksFromThread<Queue>, std::ref(pool), 100, taskClass);
     }
 
     for (auto& t : adders) {
@@ -226,5 +2001,276 @@ int main() {
 
     pool.shutdown();
     scheduler.join();
+    std::cout << "Queueing latency by class:\n";
+    pool.reportLatency(std::cout);
+}
+
+// Самоперевірки черг (--self-test): кожна порушена умова друкується, код виходу ненульовий
+bool expect(bool condition, const char* what) {
+    if (!condition) std::cerr << "FAILED: " << what << "\n";
+    return condition;
+}
+
+// Забирає всі задачі черги і позначає їхні id; false, якщо якийсь id трапився двічі
+template <typename Queue>
+bool collectIds(Queue& queue, std::vector<int>& seen) {
+    Task task;
+    bool unique = true;
+    while (queue.getTask(task)) {
+        if (seen[task.id]++) unique = false;
+    }
+    return unique;
+}
+
+// Кільця різного розміру: у менше не вміщуються всі задачі більшого, і зайві мають повернутися назад
+bool testLockFreeSwap() {
+    LockFreeTaskQueue small(4), large(8);
+    small.setVerbose(false);
+    large.setVerbose(false);
+    for (int i = 0; i < 6; ++i) large.addTask(i, 1, [] {});
+    small.addTask(6, 1, [] {});
+    small.swap(large);
+
+    bool ok = expect(small.getQueuedCount() == 4 && large.getQueuedCount() == 3, "swap keeps tasks that do not fit");
+    ok &= expect(small.getQueuedTime() == 4 && large.getQueuedTime() == 3, "swap moves queued time with the tasks");
+    std::vector<int> seen(7);
+    ok &= expect(collectIds(small, seen) && collectIds(large, seen), "swap duplicates no task");
+    ok &= expect(std::count(seen.begin(), seen.end(), 1) == 7, "swap loses no task");
+    ok &= expect(small.getQueuedTime() == 0 && large.getQueuedTime() == 0, "queued time returns to zero");
+    return ok;
+}
+
+// Основне кільце заповнене: takeAll не має нічого губити, а перенести решту, щойно звільниться місце
+bool testLockFreeTakeAll() {
+    LockFreeTaskQueue main(4), buffer(8);
+    main.setVerbose(false);
+    buffer.setVerbose(false);
+    for (int i = 0; i < 4; ++i) main.addTask(i, 1, [] {});
+    for (int i = 4; i < 10; ++i) buffer.addTask(i, 1, [] {});
+
+    main.takeAll(buffer);
+    bool ok = expect(main.getQueuedCount() == 4 && buffer.getQueuedCount() == 6, "takeAll into a full ring moves nothing");
+    ok &= expect(main.getQueuedTime() == 4 && buffer.getQueuedTime() == 6, "takeAll into a full ring keeps queued time");
+
+    std::vector<int> seen(10);
+    Task task;
+    for (int i = 0; i < 2; ++i) {
+        main.getTask(task);
+        seen[task.id]++;
+    }
+    main.takeAll(buffer);
+    ok &= expect(main.getQueuedCount() == 4 && buffer.getQueuedCount() == 4, "takeAll fills only the free slots");
+    ok &= expect(main.getQueuedTime() == 4 && buffer.getQueuedTime() == 4, "takeAll moves queued time with the tasks");
+
+    while (buffer.getQueuedCount() > 0) {
+        ok &= collectIds(main, seen);
+        main.takeAll(buffer);
+    }
+    ok &= expect(collectIds(main, seen), "takeAll duplicates no task");
+    ok &= expect(std::count(seen.begin(), seen.end(), 1) == 10, "takeAll loses no task");
+    return ok;
+}
+
+// Чекає future з обмеженням часу; "dropped" - завершився винятком TaskDropped
+template <typename T>
+std::string outcome(const TaskFuture<T>& future, std::chrono::seconds timeout) {
+    auto giveUp = Clock::now() + timeout;
+    while (!future.ready()) {
+        if (Clock::now() > giveUp) return "hung";
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    try {
+        future.get();
+        return "ok";
+    } catch (const TaskDropped&) {
+        return "dropped";
+    } catch (...) {
+        return "failed";
+    }
+}
+
+// FixedInterval: submit працює як завжди, а задача, яку скинули до виконання, завершує свій future
+// (і ланцюжок then) винятком TaskDropped, а не лишає його висіти
+template <typename Queue>
+bool testSubmitUnderFixedInterval() {
+    PoolOptions options;
+    options.quiet = true;
+    options.simulateDuration = false;
+    options.swapInterval = 1;
+
+    bool ok = true;
+    {
+        ThreadPool<Queue> pool(1, options);
+        std::thread scheduler(&ThreadPool<Queue>::scheduleExecution, &pool);
+        TaskFuture<int> doubled = pool.submit(0, [] { return 21; }).then([](int value) { return value * 2; });
+        ok &= expect(outcome(doubled, std::chrono::seconds(10)) == "ok" && doubled.get() == 42,
+                     "submit().then() completes under FixedInterval");
+        pool.shutdown();
+        scheduler.join();
+    }
+
+    // Воркер зайнятий, поки обмін не скине решту основної черги
+    std::atomic<bool> release{false};
+    TaskFuture<int> cleared;
+    TaskFuture<int> unscheduled;
+    {
+        ThreadPool<Queue> pool(1, options);
+        std::thread scheduler(&ThreadPool<Queue>::scheduleExecution, &pool);
+        TaskFuture<void> blocker = pool.submit(0, [&release] {
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+        cleared = pool.submit(0, [] { return 1; }).then([](int value) { return value + 1; });
+        ok &= expect(outcome(cleared, std::chrono::seconds(10)) == "dropped",
+                     "a task cleared by the swap fails its future chain with TaskDropped");
+        release = true;
+        ok &= expect(outcome(blocker, std::chrono::seconds(10)) == "ok", "the running task still completes");
+
+        // Ця задача лишається в буфері до зупинки пулу
+        pool.pause();
+        unscheduled = pool.submit(0, [] { return 1; });
+        pool.shutdown();
+        scheduler.join();
+    }
+    ok &= expect(outcome(unscheduled, std::chrono::seconds(1)) == "dropped",
+                 "shutdown fails the futures of tasks that never ran");
+    return ok;
+}
+
+// Задачі, що не вмістилися під час обміну, виконуються раніше за ті, що виробники додали після нього
+bool testLockFreeOverflowOrder() {
+    LockFreeTaskQueue small(4), large(8);
+    small.setVerbose(false);
+    large.setVerbose(false);
+    for (int i = 0; i < 6; ++i) large.addTask(i, 1, [] {});
+    small.swap(large);
+    for (int i = 6; i < 14; ++i) large.addTask(i, 1, [] {});
+
+    std::vector<int> order;
+    Task task;
+    while (large.getTask(task)) order.push_back(task.id);
+    std::vector<int> expected{4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+    bool ok = expect(order == expected, "tasks left over by swap run before newer arrivals");
+    ok &= expect(large.getQueuedTime() == 0, "queued time returns to zero");
+    return ok;
+}
+
+// Режим крадіжки: воркер виконує роздані планувальником задачі в порядку черги (тут - найкоротші першими)
+bool testWorkStealingOrder() {
+    PoolOptions options;
+    options.quiet = true;
+    options.simulateDuration = false;
+    options.mode = SchedulingMode::WorkStealing;
+    options.swapPolicy = SwapPolicy::EventDriven;
+    options.swapInterval = 1;
+    options.ordering = QueueOrdering::ShortestJob;
+
+    std::mutex orderMtx;
+    std::vector<int> order;
+    std::vector<int> durations{5, 1, 4, 2, 3};
+    std::vector<TaskFuture<void>> done;
+    {
+        ThreadPool<TaskQueue> pool(1, options);
+        std::thread scheduler(&ThreadPool<TaskQueue>::scheduleExecution, &pool);
+        pool.pause();
+        for (int duration : durations) {
+            done.push_back(pool.submit(duration, [&orderMtx, &order, duration] {
+                std::lock_guard<std::mutex> lock(orderMtx);
+                order.push_back(duration);
+            }));
+        }
+        pool.resume();
+        for (const TaskFuture<void>& future : done) future.wait();
+        pool.shutdown();
+        scheduler.join();
+    }
+    return expect(order == std::vector<int>{1, 2, 3, 4, 5}, "work stealing runs dispatched tasks in queue order");
+}
+
+int runSelfTests() {
+    bool ok = true;
+    ok &= testSubmitUnderFixedInterval<TaskQueue>();
+    ok &= testSubmitUnderFixedInterval<LockFreeTaskQueue>();
+    ok &= testLockFreeSwap();
+    ok &= testLockFreeTakeAll();
+    ok &= testLockFreeOverflowOrder();
+    ok &= testWorkStealingOrder();
+    std::cout << (ok ? "All self-tests passed\n" : "Self-tests failed\n");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    PoolOptions options;
+    CpuBenchSettings cpuBench;
+    bool lockFreeQueue = false;
+    bool runCpuBench = false;
+    bool runGraph = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--work-stealing") options.mode = SchedulingMode::WorkStealing;
+        else if (arg == "--event-driven") options.swapPolicy = SwapPolicy::EventDriven;
+        else if (arg.rfind("--swap-interval=", 0) == 0) options.swapInterval = std::stoi(arg.substr(16));
+        else if (arg.rfind("--swap-threshold=", 0) == 0) options.swapThreshold = std::stoi(arg.substr(17));
+        else if (arg == "--ordering=edf") options.ordering = QueueOrdering::EarliestDeadline;
+        else if (arg == "--ordering=sjf") options.ordering = QueueOrdering::ShortestJob;
+        else if (arg == "--ordering=fifo") options.ordering = QueueOrdering::Fifo;
+        else if (arg.rfind("--aging=", 0) == 0) options.agingSeconds = std::stoi(arg.substr(8));
+        else if (arg.rfind("--trace=", 0) == 0) options.tracePath = arg.substr(8);
+        else if (arg.rfind("--max-time=", 0) == 0) options.maxTime = std::stoi(arg.substr(11));
+        else if (arg == "--adaptive-admission") options.adaptiveAdmission = true;
+        else if (arg.rfind("--target-delay=", 0) == 0) options.targetDelay = std::stod(arg.substr(15));
+        else if (arg == "--backpressure=reject") options.backpressure = Backpressure::Reject;
+        else if (arg == "--backpressure=block") options.backpressure = Backpressure::Block;
+        else if (arg == "--backpressure=retry") options.backpressure = Backpressure::RetryAfter;
+        else if (arg.rfind("--max-block=", 0) == 0) options.maxBlockSeconds = std::stoi(arg.substr(12));
+        else if (arg.rfind("--pin=", 0) == 0) {
+            if (!parsePinPolicy(arg.substr(6), options.pinPolicy)) {
+                std::cerr << "Unknown pin policy: " << arg.substr(6) << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--lock-free-queue") lockFreeQueue = true;
+        else if (arg == "--bench-cpu") runCpuBench = true;
+        else if (arg == "--graph") runGraph = true;
+        else if (arg.rfind("--workers=", 0) == 0) cpuBench.workers = parseList(arg.substr(10));
+        else if (arg.rfind("--producers=", 0) == 0) cpuBench.producers = parseList(arg.substr(12));
+        else if (arg.rfind("--tasks=", 0) == 0) cpuBench.tasks = std::stoi(arg.substr(8));
+        else if (arg.rfind("--rate=", 0) == 0) cpuBench.rate = std::stod(arg.substr(7));
+        else if (arg.rfind("--matrix-size=", 0) == 0) cpuBench.matrixSize = std::stoi(arg.substr(14));
+        else if (arg.rfind("--scan-size=", 0) == 0) cpuBench.scanSize = std::stoi(arg.substr(12));
+        else if (arg == "--kernel=mirror") cpuBench.kernel = BenchKernel::Mirror;
+        else if (arg == "--kernel=scan") cpuBench.kernel = BenchKernel::Scan;
+        else if (arg == "--kernel=mixed") cpuBench.kernel = BenchKernel::Mixed;
+        else if (arg == "--bench-queue") {
+            benchmarkQueues();
+            return 0;
+        } else if (arg == "--bench-alloc") {
+            benchmarkAllocations();
+            return 0;
+        } else if (arg == "--self-test") {
+            return runSelfTests();
+        }
+    }
+
+    if (runGraph) {
+        int workers = cpuBench.workers.empty() ? 4 : cpuBench.workers.back();
+        if (lockFreeQueue) {
+            runGraphDemo<LockFreeTaskQueue>(options, workers, 1000, 10000000);
+        } else {
+            runGraphDemo<TaskQueue>(options, workers, 1000, 10000000);
+        }
+        return 0;
+    }
+
+    if (runCpuBench) {
+        bool complete = lockFreeQueue ? runCpuBenchmark<LockFreeTaskQueue>(cpuBench, options)
+                                      : runCpuBenchmark<TaskQueue>(cpuBench, options);
+        return complete ? 0 : 1;
+    }
+
+    if (lockFreeQueue) {
+        runDemo<LockFreeTaskQueue>(options);
+    } else {
+        runDemo<TaskQueue>(options);
+    }
     return 0;
 }
@@ -5,6 +5,8 @@
 #include <iomanip>
 #include <cstdint>
 #include <thread>
+#include <string>
+#include "../common/tlv_framing.h"
 
 
 #pragma comment(lib, "ws2_32.lib")
@@ -13,28 +15,17 @@ enum TLVType : uint8_t {
     TYPE_MATRIX_SIZE = 1,
     TYPE_NUM_THREADS = 2,
     TYPE_MATRIX_DATA = 3,
-    TYPE_COMMAND = 4
+    TYPE_COMMAND = 4,
+    TYPE_STREAM_BEGIN = 5,
+    TYPE_MATRIX_CHUNK = 6,
+    TYPE_RESULT_CHUNK = 7
 };
 
-void sendTLV(SOCKET socket, TLVType type, const void* data, uint32_t length) {
-    send(socket, reinterpret_cast<const char*>(&type), sizeof(type), 0);
-    send(socket, reinterpret_cast<const char*>(&length), sizeof(length), 0);
-    send(socket, reinterpret_cast<const char*>(data), length, 0);
-}
+const int STREAM_ROWS = 0; // > 0 - потоковий режим: матриця йде блоками по стільки рядків
 
-bool receiveTLV(SOCKET socket, uint8_t& type, std::vector<char>& value) {
-    uint32_t length = 0;
-    if (recv(socket, reinterpret_cast<char*>(&type), sizeof(type), 0) <= 0) return false;
-    if (recv(socket, reinterpret_cast<char*>(&length), sizeof(length), 0) <= 0) return false;
-
-    value.resize(length);
-    int received = 0;
-    while (received < static_cast<int>(length)) {
-        int chunk = recv(socket, value.data() + received, length - received, 0);
-        if (chunk <= 0) return false;
-        received += chunk;
-    }
-    return true;
+// Кадр з буфера прийому як повідомлення сервера
+std::string frameText(const TLVFrame& frame) {
+    return std::string(frame.value, frame.length);
 }
 
 void printMatrix(const std::vector<int>& matrix, int size) {
@@ -46,6 +37,51 @@ void printMatrix(const std::vector<int>& matrix, int size) {
     }
 }
 
+// Потоковий режим: сервер починає дзеркалити, поки блоки ще йдуть, і повертає готові смуги рядків
+// у довільному порядку; кожна смуга приймається прямо на своє місце в resultMatrix
+bool streamMatrix(SOCKET sock, TLVReader& reader, const std::vector<int>& matrix, int size, int numThreads,
+                  std::vector<int>& resultMatrix) {
+    char prefix[ROW_CHUNK_PREFIX];
+    encodeRowChunk(prefix, uint64_t(size), uint32_t(numThreads));
+    sendTLV(sock, TYPE_STREAM_BEGIN, prefix, ROW_CHUNK_PREFIX);
+
+    const size_t rowBytes = size_t(size) * sizeof(int);
+    for (int first = 0; first < size; first += STREAM_ROWS) {
+        uint32_t rows = uint32_t(std::min(STREAM_ROWS, size - first));
+        char header[TLV_HEADER_SIZE];
+        encodeTLVHeader(header, TYPE_MATRIX_CHUNK, uint32_t(ROW_CHUNK_PREFIX + rows * rowBytes));
+        encodeRowChunk(prefix, uint64_t(first), rows);
+        TLVChunk chunks[3] = {{header, TLV_HEADER_SIZE},
+                              {prefix, ROW_CHUNK_PREFIX},
+                              {reinterpret_cast<const char*>(matrix.data() + size_t(first) * size), rows * rowBytes}};
+        if (!sendAll(sock, chunks, 3)) return false;
+    }
+
+    resultMatrix.resize(size_t(size) * size);
+    uint8_t type;
+    uint32_t length;
+    while (receiveHeader(sock, reader, type, length)) {
+        if (type == TYPE_RESULT_CHUNK) {
+            uint64_t firstRow;
+            uint32_t rows;
+            reader.consume(TLV_HEADER_SIZE);
+            if (!receivePayload(sock, reader, prefix, ROW_CHUNK_PREFIX)) return false;
+            decodeRowChunk(prefix, firstRow, rows);
+            if (firstRow + rows > uint64_t(size)) return false;
+            char* target = reinterpret_cast<char*>(resultMatrix.data() + firstRow * size);
+            if (!receivePayload(sock, reader, target, rows * rowBytes)) return false;
+            continue;
+        }
+        TLVFrame frame;
+        if (!receiveTLV(sock, reader, frame)) return false;
+        std::string msg = frameText(frame);
+        std::cout << "Server: " << msg << std::endl;
+        if (msg == "Stream completed") return true;
+        if (msg == "Execution error") return false;
+    }
+    return false;
+}
+
 int main() {
     int size = 10, numThreads = 6;
 
@@ -70,12 +106,25 @@ int main() {
         std::cerr << "Connection failed\n";
         return 1;
     }
+    // Кожен кадр іде одним записом, тож Нейглу нічого склеювати - він лише затримував би команди
+    BOOL noDelay = TRUE;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    TLVReader reader;
+    TLVFrame frame;
+    if (receiveTLV(sock, reader, frame)) {
+        std::cout << "Server: " << frameText(frame) << std::endl;
+    }
 
-    uint8_t type;
-    std::vector<char> value;
-    if (receiveTLV(sock, type, value)) {
-        std::string msg(value.begin(), value.end());
-        std::cout << "Server: " << msg << std::endl;
+    if (STREAM_ROWS > 0) {
+        std::vector<int> resultMatrix;
+        if (streamMatrix(sock, reader, matrix, size, numThreads, resultMatrix)) {
+            std::cout << "Mirrored matrix:\n";
+            printMatrix(resultMatrix, size);
+        }
+        closesocket(sock);
+        WSACleanup();
+        return 0;
     }
 
     sendTLV(sock, TYPE_MATRIX_SIZE, &size, sizeof(size));
@@ -85,9 +134,9 @@ int main() {
     sendTLV(sock, TYPE_COMMAND, command.data(), command.size());
 
     // Читання повідомлень від сервера
-    while (receiveTLV(sock, type, value)) {
-        if (type == TYPE_COMMAND) {
-            std::string msg(value.begin(), value.end());
+    while (receiveTLV(sock, reader, frame)) {
+        if (frame.type == TYPE_COMMAND) {
+            std::string msg = frameText(frame);
             std::cout << "Server: " << msg << std::endl;
             if (msg.find("Awaiting result") != std::string::npos) break;
         }
@@ -96,19 +145,24 @@ int main() {
     // Запит статусу
     std::string status = "Status";
     sendTLV(sock, TYPE_COMMAND, status.data(), status.size());
-    if (receiveTLV(sock, type, value)) {
-        std::string msg(value.begin(), value.end());
-        std::cout << "Server: " << msg << std::endl;
+    if (receiveTLV(sock, reader, frame)) {
+        std::cout << "Server: " << frameText(frame) << std::endl;
     }
 
     // Запит результату
     std::string getResult = "Get result";
     sendTLV(sock, TYPE_COMMAND, getResult.data(), getResult.size());
 
-    if (receiveTLV(sock, type, value) && type == TYPE_MATRIX_DATA) {
-        std::vector<int> resultMatrix(reinterpret_cast<int*>(value.data()), reinterpret_cast<int*>(value.data() + value.size()));
-        std::cout << "Mirrored matrix:\n";
-        printMatrix(resultMatrix, size);
+    // Результат приймається прямо в resultMatrix, минаючи буфер кадрів
+    uint8_t type;
+    uint32_t length;
+    if (receiveHeader(sock, reader, type, length) && type == TYPE_MATRIX_DATA) {
+        reader.consume(TLV_HEADER_SIZE);
+        std::vector<int> resultMatrix(length / sizeof(int));
+        if (receivePayload(sock, reader, reinterpret_cast<char*>(resultMatrix.data()), length)) {
+            std::cout << "Mirrored matrix:\n";
+            printMatrix(resultMatrix, size);
+        }
     }
 
     closesocket(sock);
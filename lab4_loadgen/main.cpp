@@ -0,0 +1,397 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "../common/tlv_framing.h"
+
+using namespace std;
+using namespace chrono;
+
+// Генератор навантаження для lab4_server: той самий обмін, що в lab4_client
+// (розмір, потоки, дані, "Start execution", очікування, "Status", "Get result"),
+// але на багатьох одночасних неблокуючих з'єднаннях, які обслуговує кілька потоків з epoll.
+// Після кожного сеансу результат перевіряється, з'єднання відкривається наново.
+// --stream-rows=N - потоковий режим: матриця йде блоками по N рядків, результат приходить смугами.
+// Використання: lab4_loadgen [--host=127.0.0.1] [--port=7777] [--connections=1000] [--requests=10000]
+//               [--size=10] [--server-threads=6] [--threads=4] [--stream-rows=0]
+
+enum TLVType : uint8_t {
+    TYPE_MATRIX_SIZE = 1,
+    TYPE_NUM_THREADS = 2,
+    TYPE_MATRIX_DATA = 3,
+    TYPE_COMMAND = 4,
+    TYPE_STREAM_BEGIN = 5,
+    TYPE_MATRIX_CHUNK = 6,
+    TYPE_RESULT_CHUNK = 7
+};
+
+struct Settings {
+    string host = "127.0.0.1";
+    int port = 7777;
+    int connections = 1000;
+    long long requests = 10000;
+    int size = 10;
+    int serverThreads = 6;
+    int threads = 4;
+    int streamRows = 0;
+};
+
+// Етапи сеансу одного клієнта
+enum class Stage {
+    Connecting,
+    AwaitGreeting,   // "Connected to server"
+    AwaitExecution,  // квитанції на кадри, до "Awaiting result"
+    AwaitStatus,
+    AwaitResult,
+    AwaitStream      // смуги результату, до "Stream completed"
+};
+
+struct Client {
+    int fd = -1;
+    Stage stage = Stage::Connecting;
+    TLVReader in;
+    vector<char> out;
+    size_t outStart = 0;
+    steady_clock::time_point started;
+    uint64_t rowsReceived = 0;
+};
+
+struct Stats {
+    vector<long long> latencies; // мікросекунди від connect до отримання результату
+    vector<long long> firstChunk; // у потоковому режимі: до першої смуги результату
+    long long errors = 0;
+    long long mismatches = 0;
+};
+
+void appendCommand(vector<char>& out, const string& command) {
+    appendTLV(out, TYPE_COMMAND, command.data(), uint32_t(command.size()));
+}
+
+// Один потік генератора: власний epoll і власна частина з'єднань
+class Worker {
+public:
+    Worker(const Settings& settings, sockaddr_in server, int connections, atomic<long long>& budget,
+           const vector<int>& matrix, const vector<int>& expected)
+        : settings(settings), server(server), clients(connections), budget(budget), matrix(matrix), expected(expected) {
+        epollFd = epoll_create1(0);
+        // Перші чотири кадри однакові для всіх сеансів, як і в lab4_client вони йдуть без очікування квитанцій
+        if (settings.streamRows > 0) {
+            buildStreamRequest();
+            return;
+        }
+        appendTLV(request, TYPE_MATRIX_SIZE, &settings.size, sizeof(settings.size));
+        appendTLV(request, TYPE_NUM_THREADS, &settings.serverThreads, sizeof(settings.serverThreads));
+        appendTLV(request, TYPE_MATRIX_DATA, matrix.data(), uint32_t(matrix.size() * sizeof(int)));
+        appendCommand(request, "Start execution");
+    }
+
+    ~Worker() { close(epollFd); }
+
+    void run() {
+        int active = 0;
+        for (auto& client : clients) {
+            if (startSession(client)) active++;
+        }
+        vector<epoll_event> events(256);
+        while (active > 0) {
+            int count = epoll_wait(epollFd, events.data(), int(events.size()), 1000);
+            if (count < 0 && errno != EINTR) break;
+            for (int e = 0; e < count; ++e) {
+                Client& client = clients[events[e].data.u32];
+                bool ok = (events[e].events & EPOLLERR) == 0;
+                if (!ok) stats.errors++;
+                if (ok && client.stage == Stage::Connecting) ok = finishConnect(client);
+                if (ok && (events[e].events & EPOLLOUT)) ok = flush(client);
+                if (ok && (events[e].events & (EPOLLIN | EPOLLHUP))) ok = readFrames(client);
+                if (ok) continue;
+                // Сеанс завершено (успішно чи ні) - з'єднання закривається, за наявності бюджету відкривається нове
+                closeClient(client);
+                if (!startSession(client)) active--;
+            }
+        }
+    }
+
+    Stats stats;
+
+private:
+    void buildStreamRequest() {
+        char prefix[ROW_CHUNK_PREFIX];
+        encodeRowChunk(prefix, uint64_t(settings.size), uint32_t(settings.serverThreads));
+        appendTLV(request, TYPE_STREAM_BEGIN, prefix, ROW_CHUNK_PREFIX);
+        size_t rowBytes = size_t(settings.size) * sizeof(int);
+        for (int first = 0; first < settings.size; first += settings.streamRows) {
+            uint32_t rows = uint32_t(min(settings.streamRows, settings.size - first));
+            encodeRowChunk(prefix, uint64_t(first), rows);
+            appendTLVHeader(request, TYPE_MATRIX_CHUNK, uint32_t(ROW_CHUNK_PREFIX + rows * rowBytes));
+            request.insert(request.end(), prefix, prefix + ROW_CHUNK_PREFIX);
+            const char* data = reinterpret_cast<const char*>(matrix.data() + size_t(first) * settings.size);
+            request.insert(request.end(), data, data + rows * rowBytes);
+        }
+    }
+
+    // Смуга результату має збігтися з відповідними рядками очікуваної матриці
+    bool checkResultChunk(Client& client, const char* value, uint32_t length) {
+        uint64_t firstRow;
+        uint32_t rowCount;
+        if (length < ROW_CHUNK_PREFIX) return false;
+        decodeRowChunk(value, firstRow, rowCount);
+        size_t rowBytes = size_t(settings.size) * sizeof(int);
+        if (firstRow + rowCount > uint64_t(settings.size) || length != ROW_CHUNK_PREFIX + rowCount * rowBytes) return false;
+        if (client.rowsReceived == 0) {
+            stats.firstChunk.push_back(duration_cast<microseconds>(steady_clock::now() - client.started).count());
+        }
+        client.rowsReceived += rowCount;
+        return memcmp(value + ROW_CHUNK_PREFIX, expected.data() + firstRow * settings.size, rowCount * rowBytes) == 0;
+    }
+
+    // Бере наступний запит зі спільного бюджету; false - запити скінчилися
+    bool startSession(Client& client) {
+        while (budget.fetch_sub(1) > 0) {
+            client = Client();
+            client.started = steady_clock::now();
+            client.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            int one = 1;
+            setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (connect(client.fd, (sockaddr*)&server, sizeof(server)) < 0 && errno != EINPROGRESS) {
+                stats.errors++;
+                close(client.fd);
+                client.fd = -1;
+                continue;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT;
+            ev.data.u32 = uint32_t(&client - clients.data());
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &ev);
+            return true;
+        }
+        return false;
+    }
+
+    bool finishConnect(Client& client) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(client.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            stats.errors++;
+            return false;
+        }
+        client.stage = Stage::AwaitGreeting;
+        return true;
+    }
+
+    void closeClient(Client& client) {
+        if (client.fd < 0) return;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+        close(client.fd);
+        client.fd = -1;
+    }
+
+    void send(Client& client, const vector<char>& data) {
+        client.out.insert(client.out.end(), data.begin(), data.end());
+    }
+
+    bool flush(Client& client) {
+        while (client.outStart < client.out.size()) {
+            ssize_t sent = ::send(client.fd, client.out.data() + client.outStart, client.out.size() - client.outStart, MSG_NOSIGNAL);
+            if (sent > 0) {
+                client.outStart += sent;
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+            stats.errors++;
+            return false;
+        }
+        client.out.clear();
+        client.outStart = 0;
+        return true;
+    }
+
+    // Повертає false, коли сеанс скінчився: результат отримано або сталася помилка
+    bool readFrames(Client& client) {
+        bool eof = false;
+        while (true) {
+            char* target = client.in.writePtr();
+            ssize_t received = recv(client.fd, target, client.in.writable(), 0);
+            if (received > 0) {
+                client.in.commit(received);
+                continue;
+            }
+            if (received < 0 && errno == EINTR) continue;
+            // Сервер закриває з'єднання одразу після результату, тож спершу розбираються вже прийняті кадри
+            eof = !(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+            break;
+        }
+
+        TLVFrame frame;
+        while (client.in.next(frame)) {
+            if (!handleFrame(client, frame.type, frame.value, frame.length)) return false;
+        }
+        if (eof) {
+            stats.errors++; // з'єднання закрилося до отримання результату
+            return false;
+        }
+        return flush(client);
+    }
+
+    bool handleFrame(Client& client, uint8_t type, const char* value, uint32_t length) {
+        string msg = type == TYPE_COMMAND ? string(value, length) : string();
+        switch (client.stage) {
+            case Stage::AwaitGreeting:
+                client.stage = settings.streamRows > 0 ? Stage::AwaitStream : Stage::AwaitExecution;
+                send(client, request);
+                return true;
+            case Stage::AwaitExecution:
+                if (msg == "Execution error") {
+                    stats.errors++;
+                    return false;
+                }
+                if (msg.find("Awaiting result") != string::npos) {
+                    client.stage = Stage::AwaitStatus;
+                    appendCommand(client.out, "Status");
+                }
+                return true;
+            case Stage::AwaitStatus:
+                client.stage = Stage::AwaitResult;
+                appendCommand(client.out, "Get result");
+                return true;
+            case Stage::AwaitResult:
+                if (type != TYPE_MATRIX_DATA) return true;
+                if (length != expected.size() * sizeof(int) || memcmp(value, expected.data(), length) != 0) {
+                    stats.mismatches++;
+                }
+                stats.latencies.push_back(duration_cast<microseconds>(steady_clock::now() - client.started).count());
+                return false;
+            case Stage::AwaitStream:
+                if (type == TYPE_RESULT_CHUNK) {
+                    if (!checkResultChunk(client, value, length)) stats.mismatches++;
+                    return true;
+                }
+                if (msg == "Execution error") {
+                    stats.errors++;
+                    return false;
+                }
+                if (msg != "Stream completed") return true;
+                if (client.rowsReceived != uint64_t(settings.size)) stats.mismatches++;
+                stats.latencies.push_back(duration_cast<microseconds>(steady_clock::now() - client.started).count());
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    const Settings& settings;
+    sockaddr_in server;
+    vector<Client> clients;
+    atomic<long long>& budget;
+    const vector<int>& matrix;
+    const vector<int>& expected;
+    vector<char> request;
+    int epollFd;
+};
+
+long long percentile(const vector<long long>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = min(sorted.size() - 1, size_t(p / 100.0 * sorted.size()));
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.substr(arg.find('=') + 1);
+        if (arg.rfind("--host=", 0) == 0) settings.host = value;
+        else if (arg.rfind("--port=", 0) == 0) settings.port = atoi(value.c_str());
+        else if (arg.rfind("--connections=", 0) == 0) settings.connections = max(1, atoi(value.c_str()));
+        else if (arg.rfind("--requests=", 0) == 0) settings.requests = max(1LL, atoll(value.c_str()));
+        else if (arg.rfind("--size=", 0) == 0) settings.size = max(1, atoi(value.c_str()));
+        else if (arg.rfind("--server-threads=", 0) == 0) settings.serverThreads = max(1, atoi(value.c_str()));
+        else if (arg.rfind("--threads=", 0) == 0) settings.threads = max(1, atoi(value.c_str()));
+        else if (arg.rfind("--stream-rows=", 0) == 0) settings.streamRows = max(0, atoi(value.c_str()));
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+    settings.threads = min(settings.threads, settings.connections);
+
+    signal(SIGPIPE, SIG_IGN);
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(settings.port);
+    if (inet_pton(AF_INET, settings.host.c_str(), &server.sin_addr) != 1) {
+        cerr << "Invalid host: " << settings.host << endl;
+        return 1;
+    }
+
+    // Одна матриця на всі сеанси і очікуване віддзеркалення відносно побічної діагоналі
+    int size = settings.size;
+    vector<int> matrix(size_t(size) * size), expected(matrix.size());
+    for (size_t i = 0; i < matrix.size(); i++) matrix[i] = int(i % 99) + 1;
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            expected[size_t(i) * size + j] = matrix[size_t(size - 1 - j) * size + (size - 1 - i)];
+        }
+    }
+
+    atomic<long long> budget(settings.requests);
+    vector<unique_ptr<Worker>> workers;
+    for (int t = 0; t < settings.threads; t++) {
+        int connections = settings.connections / settings.threads + (t < settings.connections % settings.threads ? 1 : 0);
+        workers.push_back(make_unique<Worker>(settings, server, connections, budget, matrix, expected));
+    }
+
+    auto startTime = steady_clock::now();
+    vector<thread> threads;
+    for (auto& worker : workers) threads.emplace_back([&worker] { worker->run(); });
+    for (auto& t : threads) t.join();
+    double seconds = duration<double>(steady_clock::now() - startTime).count();
+
+    vector<long long> latencies, firstChunk;
+    long long errors = 0, mismatches = 0;
+    for (auto& worker : workers) {
+        latencies.insert(latencies.end(), worker->stats.latencies.begin(), worker->stats.latencies.end());
+        firstChunk.insert(firstChunk.end(), worker->stats.firstChunk.begin(), worker->stats.firstChunk.end());
+        errors += worker->stats.errors;
+        mismatches += worker->stats.mismatches;
+    }
+    sort(latencies.begin(), latencies.end());
+    sort(firstChunk.begin(), firstChunk.end());
+
+    cout << "Connections: " << settings.connections << ", threads: " << settings.threads
+         << ", matrix: " << size << "x" << size;
+    if (settings.streamRows > 0) cout << ", streamed in blocks of " << settings.streamRows << " rows";
+    cout << endl;
+    cout << "Completed: " << latencies.size() << ", errors: " << errors << ", wrong results: " << mismatches << endl;
+    cout << fixed << setprecision(1);
+    cout << "Time: " << seconds << " s, requests/s: " << latencies.size() / seconds << endl;
+    cout << "Latency us: p50 " << percentile(latencies, 50) << ", p90 " << percentile(latencies, 90)
+         << ", p99 " << percentile(latencies, 99) << ", max " << (latencies.empty() ? 0 : latencies.back()) << endl;
+    if (!firstChunk.empty()) {
+        cout << "First result chunk us: p50 " << percentile(firstChunk, 50) << ", p99 " << percentile(firstChunk, 99) << endl;
+    }
+    return errors > 0 || mismatches > 0 ? 1 : 0;
+}
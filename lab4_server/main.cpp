@@ -1,18 +1,53 @@
 #include <iostream>
+#ifdef _WIN32
 #include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <csignal>
+#endif
 #include <vector>
 #include <chrono>
 #include <thread>
 #include <cstring>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <unordered_map>
+#include <string>
+#include <algorithm>
+#include <charconv>
+#include "../common/affinity.h"
+#include "../common/tlv_framing.h"
+#include "../common/tile_mirror.h"
 
+#ifdef _WIN32
 #pragma comment(lib, "ws2_32.lib")
+#endif
+
+const PinPolicy PIN = PinPolicy::Scatter; // Закріплення потоків обробки за ядрами (None - на розсуд ОС)
 
 enum TLVType : uint8_t {
     TYPE_MATRIX_SIZE = 1,
     TYPE_NUM_THREADS = 2,
     TYPE_MATRIX_DATA = 3,
-    TYPE_COMMAND = 4
+    TYPE_COMMAND = 4,
+    // Потоковий режим
+    TYPE_STREAM_BEGIN = 5,  // uint64 розмір матриці, uint32 кількість потоків (формат префікса блоку)
+    TYPE_MATRIX_CHUNK = 6,  // префікс блоку рядків (tlv_framing.h) і рядки, від клієнта
+    TYPE_RESULT_CHUNK = 7   // те саме від сервера: готові рядки результату
 };
 
 enum Status {
@@ -21,169 +56,678 @@ enum Status {
     COMPLETED
 };
 
-std::mutex statusMutex;
-Status currentStatus = IDLE;
-std::vector<int> resultMatrix;
+const int TILE = 32; // Сторона тайла дзеркалення: пара тайлів 32x32 int (8 КБ) вміщується в L1
+const size_t MATRIX_ALIGN = 4096; // Буфер матриці вирівняний на сторінку
+// Довший кадр вважається помилкою протоколу, з'єднання закривається. Через буфер кадрів ідуть лише
+// розміри і команди; дані матриці та блоки рядків приймаються в обхід нього
+const uint32_t MAX_FRAME = 64u << 10;
+// Сумарний обсяг буферів матриць усіх з'єднань і задач. Розмір задає клієнт, тож виділення понад
+// бюджет відхиляється (std::bad_alloc, клієнт отримує "Memory error") ще до звернення до ОС
+const uint64_t MATRIX_MEMORY_LIMIT = 8ull << 30;
+
+std::atomic<uint64_t> matrixMemoryUsed{0};
 
-void sendTLV(SOCKET socket, TLVType type, const void* data, uint32_t length) {
-    send(socket, reinterpret_cast<const char*>(&type), sizeof(type), 0);
-    send(socket, reinterpret_cast<const char*>(&length), sizeof(length), 0);
-    send(socket, reinterpret_cast<const char*>(data), length, 0);
+size_t matrixBytes(int size) {
+    return size <= 0 ? 0 : size_t(size) * size * sizeof(int);
 }
 
-bool receiveTLV(SOCKET socket, uint8_t& type, std::vector<char>& value) {
-    uint32_t length = 0;
-    if (recv(socket, reinterpret_cast<char*>(&type), sizeof(type), 0) <= 0) return false;
-    if (recv(socket, reinterpret_cast<char*>(&length), sizeof(length), 0) <= 0) return false;
+// Матриця зберігається одним суцільним буфером: дані приймаються з сокета прямо в нього,
+// дзеркалення відбувається на місці, і результат відправляється з нього ж
+struct AlignedDelete {
+    size_t bytes = 0; // Повертається в бюджет разом із буфером
 
-    value.resize(length);
-    int received = 0;
-    while (received < static_cast<int>(length)) {
-        int chunk = recv(socket, value.data() + received, length - received, 0);
-        if (chunk <= 0) return false;
-        received += chunk;
+    void operator()(int* data) const {
+        ::operator delete[](data, std::align_val_t(MATRIX_ALIGN));
+        matrixMemoryUsed.fetch_sub(bytes);
+    }
+};
+
+using MatrixBuffer = std::unique_ptr<int[], AlignedDelete>;
+
+// Без ініціалізації: кожен байт буде перезаписаний прийнятими даними
+MatrixBuffer allocateMatrix(int size) {
+    size_t bytes = std::max<size_t>(1, matrixBytes(size));
+    if (matrixMemoryUsed.fetch_add(bytes) + bytes > MATRIX_MEMORY_LIMIT) {
+        matrixMemoryUsed.fetch_sub(bytes);
+        throw std::bad_alloc();
+    }
+    try {
+        return MatrixBuffer(static_cast<int*>(::operator new[](bytes, std::align_val_t(MATRIX_ALIGN))),
+                            AlignedDelete{bytes});
+    } catch (...) {
+        matrixMemoryUsed.fetch_sub(bytes);
+        throw;
     }
-    return true;
 }
 
-void mirrorMatrix(int** matrix, int size, int numThreads) {
-    std::vector<std::thread> threads;
-    auto swap = [&](int start, int end) {
-        for (int i = start; i < end; ++i) {
-            for (int j = 0; j < size - 1 - i; ++j) {
-                std::swap(matrix[i][j], matrix[size - 1 - j][size - 1 - i]);
+// Фіксований пул обчислювальних потоків
+class ComputePool {
+public:
+    explicit ComputePool(int workers) {
+        for (int i = 0; i < workers; ++i) {
+            threads.emplace_back([this, i] {
+                pinCurrentThread(PIN, i);
+                workerLoop();
+            });
+        }
+    }
+
+    ~ComputePool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    int size() const { return int(threads.size()); }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stop || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
             }
+            job();
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool stop = false;
+    std::vector<std::thread> threads;
+};
+
+const int PAIRS_PER_JOB = 64; // Пар тайлів в одній задачі потокового режиму
+
+// Потокове дзеркалення: рядки приходять блоками в довільному порядку, і пара тайлів (R, C)
+// обробляється, щойно прийшли обидві смуги рядків R і C. Смуга готова до відправлення, коли
+// оброблені всі пари, що її зачіпають. Рядок результату залежить від стовпця всієї матриці,
+// тож перша смуга буде готова лише після приходу останньої, але відправлення готових смуг
+// перекривається з обробкою решти, а обробка - з прийомом
+class StreamingMirror : public std::enable_shared_from_this<StreamingMirror> {
+public:
+    using Submit = std::function<void(std::function<void()>)>;
+    using TileDone = std::function<void(int)>; // Викликається з потоку обчислень
+
+    StreamingMirror(int size, Submit submit, TileDone tileDone)
+        : size(size), tiles((size + TILE - 1) / TILE), matrix(allocateMatrix(size)), rowSeen(size, 0),
+          rowsInTile(tiles, 0), remaining(new std::atomic<int>[tiles]), submit(std::move(submit)),
+          tileDone(std::move(tileDone)) {
+        // Смуга R бере участь у парах з кожною смугою, включно з собою
+        for (int t = 0; t < tiles; ++t) remaining[t].store(tiles);
+    }
+
+    int matrixSize() const { return size; }
+    int tileCount() const { return tiles; }
+    bool uploaded() const { return receivedRows == uint64_t(size); }
+
+    int tileFirstRow(int tile) const { return tile * TILE; }
+    int tileRows(int tile) const { return std::min(TILE, size - tile * TILE); }
+
+    int* rows(uint64_t firstRow) { return matrix.get() + firstRow * size; }
+
+    // Блок у межах матриці і жоден його рядок ще не приходив
+    bool canAccept(uint64_t firstRow, uint64_t rowCount) const {
+        if (rowCount == 0 || firstRow >= uint64_t(size) || rowCount > uint64_t(size) - firstRow) return false;
+        for (uint64_t r = firstRow; r < firstRow + rowCount; ++r) {
+            if (rowSeen[r]) return false;
+        }
+        return true;
+    }
+
+    // Рядки вже записані в rows(firstRow); кожна смуга, що стала повною, запускає пари з усіма повними смугами
+    void addRows(uint64_t firstRow, uint32_t rowCount) {
+        std::vector<std::pair<int, int>> ready;
+        for (uint64_t r = firstRow; r < firstRow + rowCount; ++r) {
+            rowSeen[r] = 1;
+            int tile = int(r / TILE);
+            if (++rowsInTile[tile] < tileRows(tile)) continue;
+            arrivedTiles.push_back(tile);
+            for (int other : arrivedTiles) ready.emplace_back(std::min(tile, other), std::max(tile, other));
+        }
+        receivedRows += rowCount;
+
+        auto self = shared_from_this();
+        for (size_t first = 0; first < ready.size(); first += PAIRS_PER_JOB) {
+            std::vector<std::pair<int, int>> pairs(ready.begin() + first,
+                                                   ready.begin() + std::min(ready.size(), first + PAIRS_PER_JOB));
+            submit([self, pairs] {
+                for (auto& pair : pairs) self->mirrorPair(pair.first, pair.second);
+            });
+        }
+    }
+
+private:
+    void mirrorPair(int R, int C) {
+        swapTilePair(matrix.get(), size, R, C, TILE);
+        tileFinished(R);
+        if (C != R) tileFinished(C);
+    }
+
+    void tileFinished(int tile) {
+        if (remaining[tile].fetch_sub(1, std::memory_order_acq_rel) == 1) tileDone(tile);
+    }
+
+    int size;
+    int tiles;
+    MatrixBuffer matrix;
+    std::vector<char> rowSeen;
+    std::vector<int> rowsInTile;
+    std::vector<int> arrivedTiles;
+    std::unique_ptr<std::atomic<int>[]> remaining; // Необроблених пар, що зачіпають смугу
+    uint64_t receivedRows = 0;
+    Submit submit;
+    TileDone tileDone;
+};
+
+const long long JOB_STEP_WEIGHT = 256; // Ваги пар тайлів між оновленнями прогресу і перевірками скасування
+const size_t MAX_JOBS = 1024; // Незабраних задач "Submit job" одночасно
+// Завершена задача "Submit job", чий результат не забрали, або скасована, про яку не запитали,
+// зникає з таблиці через цей час: інакше кинуті клієнтами матриці займали б пам'ять назавжди
+const auto JOB_RESULT_TTL = std::chrono::minutes(10);
+
+enum class JobState {
+    Queued,
+    Running,
+    Completed,
+    Cancelled
+};
+
+// Задача дзеркалення на спільному пулі. Матриця належить задачі; читати її можна лише після того,
+// як state() став Completed. Скасування перевіряється між кроками по JOB_STEP_WEIGHT
+class Job {
+public:
+    using OnFinish = std::function<void(Job&)>; // Викликається з потоку обчислень
+
+    Job(uint64_t id, MatrixBuffer matrix, int size, OnFinish onFinish)
+        : jobId(id), matrixSize(size), totalWeight(tileWeight(size, TILE)), matrix(std::move(matrix)),
+          onFinish(std::move(onFinish)) {}
+
+    uint64_t id() const { return jobId; }
+    int size() const { return matrixSize; }
+    const int* data() const { return matrix.get(); }
+    MatrixBuffer takeMatrix() { return std::move(matrix); }
+
+    JobState state() const { return JobState(stateValue.load(std::memory_order_acquire)); }
+    bool finished() const { return state() == JobState::Completed || state() == JobState::Cancelled; }
+
+    // Частка виконаної роботи у відсотках, за вагою оброблених пар тайлів
+    int progress() const {
+        return totalWeight == 0 ? 100 : int(doneWeight.load(std::memory_order_relaxed) * 100 / totalWeight);
+    }
+
+    std::string statusText() const {
+        // Після успішного cancel задача вже не завершиться як Completed, навіть якщо частини ще працюють
+        if (cancelRequested.load(std::memory_order_relaxed)) return "cancelled";
+        switch (state()) {
+            case JobState::Queued: return "queued";
+            case JobState::Running: return "processing " + std::to_string(progress()) + "%";
+            case JobState::Completed: return "completed";
+            default: return "cancelled";
+        }
+    }
+
+    bool cancelled() const { return cancelRequested.load(std::memory_order_relaxed); }
+
+    // false - задача вже завершилася успішно, результат лишається. Під mtx разом з finish,
+    // тож скасування або встигає до рішення про стан, або бачить Completed
+    bool cancel() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (state() == JobState::Completed) return false;
+        cancelRequested.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Задача завершилася давніше, ніж TTL тому
+    bool expired(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return finished() && now - finishedAt >= JOB_RESULT_TTL;
+    }
+
+    // До завершення задачі і виходу з onFinish: повідомлення про завершення, яке він відправляє,
+    // не переплутається з відповіддю, що йде після wait
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return notified; });
+    }
+
+private:
+    friend class JobManager;
+
+    void runPart(long long firstWeight, long long lastWeight) {
+        int queued = int(JobState::Queued);
+        stateValue.compare_exchange_strong(queued, int(JobState::Running));
+        for (long long step = firstWeight; step < lastWeight; step += JOB_STEP_WEIGHT) {
+            if (cancelRequested.load(std::memory_order_relaxed)) break;
+            long long stepEnd = std::min(lastWeight, step + JOB_STEP_WEIGHT);
+            mirrorTilePairs(matrix.get(), matrixSize, step, stepEnd, TILE);
+            doneWeight.fetch_add(stepEnd - step, std::memory_order_relaxed);
+        }
+        if (pendingParts.fetch_sub(1, std::memory_order_acq_rel) == 1) finish();
+    }
+
+    // Остання частина: недороблена матриця скасованої задачі нікому не потрібна
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            bool cancelled = cancelRequested.load(std::memory_order_relaxed) ||
+                             doneWeight.load(std::memory_order_relaxed) < totalWeight;
+            if (cancelled) matrix.reset();
+            stateValue.store(int(cancelled ? JobState::Cancelled : JobState::Completed), std::memory_order_release);
+            finishedAt = std::chrono::steady_clock::now();
+        }
+        if (onFinish) onFinish(*this);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            notified = true;
+        }
+        cv.notify_all();
+    }
+
+    const uint64_t jobId;
+    const int matrixSize;
+    const long long totalWeight;
+    MatrixBuffer matrix;
+    OnFinish onFinish;
+    std::atomic<int> stateValue{int(JobState::Queued)};
+    std::atomic<long long> doneWeight{0};
+    std::atomic<int> pendingParts{0};
+    std::atomic<bool> cancelRequested{false};
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool notified = false; // onFinish відпрацював; під mtx
+    std::chrono::steady_clock::time_point finishedAt; // Під mtx
+};
+
+using JobPtr = std::shared_ptr<Job>;
+
+// Задачі всіх з'єднань на одному пулі. Задачі "Submit job" потрапляють у таблицю за номером,
+// тож стан і результат можна запитати з будь-якого з'єднання; задача "Start execution" належить
+// лише своєму з'єднанню і в таблицю не потрапляє
+class JobManager {
+public:
+    explicit JobManager(ComputePool& pool) : pool(pool) {}
+
+    // Матриця переходить до задачі лише в разі успіху; nullptr - таблиця заповнена.
+    // Частин стільки, скільки потоків просив клієнт, але не більше, ніж потоків у пулі
+    JobPtr start(MatrixBuffer& matrix, int size, int numThreads, bool listed, Job::OnFinish onFinish = nullptr) {
+        JobPtr job;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (listed) evictExpired();
+            if (listed && jobs.size() >= MAX_JOBS) return nullptr;
+            job = std::make_shared<Job>(nextId++, std::move(matrix), size, std::move(onFinish));
+            if (listed) jobs[job->id()] = job;
         }
-    };
+        long long total = job->totalWeight;
+        int parts = int(std::clamp<long long>(numThreads, 1, std::max<long long>(1, std::min<long long>(total, pool.size()))));
+        job->pendingParts.store(parts);
+        for (int part = 0; part < parts; ++part) {
+            pool.submit([job, total, parts, part] { job->runPart(total * part / parts, total * (part + 1) / parts); });
+        }
+        return job;
+    }
 
-    int block = size / numThreads;
-    int start = 0, end = block;
+    // Скасована задача відповідає "cancelled" один раз і після цього зникає з таблиці
+    std::string status(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mtx);
+        evictExpired();
+        auto it = jobs.find(id);
+        if (it == jobs.end()) return "Unknown job";
+        std::string text = it->second->statusText();
+        if (it->second->cancelled()) jobs.erase(it);
+        return text;
+    }
+
+    // Готова задача віддається і зникає з таблиці: результат забирається один раз.
+    // nullptr - задачі немає або вона ще не готова, відповідь тоді дає status
+    JobPtr take(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = jobs.find(id);
+        if (it == jobs.end() || it->second->state() != JobState::Completed) return nullptr;
+        JobPtr job = std::move(it->second);
+        jobs.erase(it);
+        return job;
+    }
 
-    for (int i = 0; i < numThreads - 1; ++i) {
-        threads.emplace_back(swap, start, end);
-        start = end;
-        end += block;
+    // Задача лишається в таблиці, поки про скасування не запитають або не мине JOB_RESULT_TTL;
+    // пам'ять звільняє її остання частина
+    std::string cancel(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) return "Unknown job";
+        return it->second->cancel() ? "cancelled" : "completed";
     }
 
-    threads.emplace_back(swap, start, size);
+private:
+    // Під mtx
+    void evictExpired() {
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            it = it->second->expired(now) ? jobs.erase(it) : std::next(it);
+        }
+    }
+
+    ComputePool& pool;
+    std::mutex mtx;
+    std::unordered_map<uint64_t, JobPtr> jobs;
+    uint64_t nextId = 1;
+};
 
-    for (auto& t : threads) t.join();
+// "Status 17" -> 17; false, якщо команда інша або після назви не номер
+bool parseJobCommand(const std::string& command, const std::string& name, uint64_t& id) {
+    if (command.size() <= name.size() + 1 || command.compare(0, name.size(), name) != 0 || command[name.size()] != ' ') {
+        return false;
+    }
+    const char* first = command.data() + name.size() + 1;
+    const char* last = command.data() + command.size();
+    auto [end, error] = std::from_chars(first, last, id);
+    return error == std::errc() && end == last;
+}
+
+#ifdef _WIN32
+
+// Сокет з'єднання: крім його потоку, пише потік обчислень, що повідомляє про завершення задачі
+struct ClientSocket {
+    SOCKET socket;
+    std::mutex sendMtx;
+    bool closed = false;
+
+    explicit ClientSocket(SOCKET socket) : socket(socket) {}
+
+    bool send(uint8_t type, const void* data, uint32_t length) {
+        std::lock_guard<std::mutex> lock(sendMtx);
+        return !closed && sendTLV(socket, type, data, length);
+    }
+
+    bool send(const std::string& message) { return send(TYPE_COMMAND, message.data(), uint32_t(message.size())); }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(sendMtx);
+        if (!closed) closesocket(socket);
+        closed = true;
+    }
+};
+
+// Спільний пул обчислень усіх з'єднань: і задач, і потокового режиму
+ComputePool& computePool() {
+    static ComputePool pool(int(std::max(1u, std::thread::hardware_concurrency())));
+    return pool;
+}
+
+// Таблиця задач усіх з'єднань
+JobManager& jobManager() {
+    static JobManager jobs(computePool());
+    return jobs;
+}
+
+// Готові смуги потокового режиму: потоки пулу додають, потік з'єднання відправляє
+struct ReadyTiles {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<int> tiles;
+};
+
+// Потоковий режим: блоки рядків приймає потік з'єднання, пари тайлів обробляє спільний пул, тож
+// кількість потоків від клієнта тут лише для сумісності, як і в циклі подій Linux. Після останнього
+// блоку готові смуги відправляються в міру завершення. Пари можуть ще оброблятися після виходу з
+// функції через помилку, тому черга готових смуг спільна з ними.
+// false - помилка протоколу або з'єднання; з'єднання після потокового режиму закривається в будь-якому разі
+bool streamExecution(ClientSocket& client, TLVReader& reader, int size) {
+    SOCKET socket = client.socket;
+    auto readyTiles = std::make_shared<ReadyTiles>();
+    ReadyTiles& ready = *readyTiles;
+    auto stream = std::make_shared<StreamingMirror>(
+        size, [](std::function<void()> job) { computePool().submit(std::move(job)); },
+        [readyTiles](int tile) {
+            {
+                std::lock_guard<std::mutex> lock(readyTiles->mtx);
+                readyTiles->tiles.push_back(tile);
+            }
+            readyTiles->cv.notify_one();
+        });
+    client.send("Stream begin");
+
+    const uint64_t rowBytes = uint64_t(size) * sizeof(int);
+    while (!stream->uploaded()) {
+        uint8_t type;
+        uint32_t length;
+        if (!receiveHeader(socket, reader, type, length)) return false;
+        if (type != TYPE_MATRIX_CHUNK) {
+            TLVFrame frame;
+            if (!receiveTLV(socket, reader, frame)) return false;
+            bool status = frame.type == TYPE_COMMAND && std::string(frame.value, frame.length) == "Status";
+            client.send(status ? "processing" : "Execution error");
+            continue;
+        }
+
+        char prefix[ROW_CHUNK_PREFIX];
+        uint64_t firstRow;
+        uint32_t rowCount;
+        reader.consume(TLV_HEADER_SIZE);
+        if (length < ROW_CHUNK_PREFIX || !receivePayload(socket, reader, prefix, ROW_CHUNK_PREFIX)) return false;
+        decodeRowChunk(prefix, firstRow, rowCount);
+        if (length != ROW_CHUNK_PREFIX + rowCount * rowBytes || !stream->canAccept(firstRow, rowCount)) {
+            std::cerr << "[ERROR] Invalid matrix chunk: rows " << firstRow << " + " << rowCount << std::endl;
+            client.send("Execution error");
+            return false;
+        }
+        if (!receivePayload(socket, reader, reinterpret_cast<char*>(stream->rows(firstRow)), rowCount * rowBytes)) return false;
+        stream->addRows(firstRow, rowCount);
+    }
+    std::cout << "[LOG] Stream upload completed" << std::endl;
+
+    for (int sent = 0; sent < stream->tileCount(); ++sent) {
+        int tile;
+        {
+            std::unique_lock<std::mutex> lock(ready.mtx);
+            ready.cv.wait(lock, [&ready] { return !ready.tiles.empty(); });
+            tile = ready.tiles.front();
+            ready.tiles.pop_front();
+        }
+        // Смуга більше не змінюється: заголовок, префікс і рядки одним векторним записом з буфера матриці
+        uint32_t rowCount = uint32_t(stream->tileRows(tile));
+        uint64_t firstRow = uint64_t(stream->tileFirstRow(tile));
+        char header[TLV_HEADER_SIZE];
+        char prefix[ROW_CHUNK_PREFIX];
+        encodeTLVHeader(header, TYPE_RESULT_CHUNK, uint32_t(ROW_CHUNK_PREFIX + rowCount * rowBytes));
+        encodeRowChunk(prefix, firstRow, rowCount);
+        TLVChunk chunks[3] = {{header, TLV_HEADER_SIZE},
+                              {prefix, ROW_CHUNK_PREFIX},
+                              {reinterpret_cast<const char*>(stream->rows(firstRow)), size_t(rowCount * rowBytes)}};
+        std::lock_guard<std::mutex> lock(client.sendMtx);
+        if (!sendAll(socket, chunks, 3)) return false;
+    }
+    std::cout << "[LOG] Stream completed" << std::endl;
+    client.send("Stream completed");
+    return true;
 }
 
 void taskExecution(SOCKET socket) {
+    auto client = std::make_shared<ClientSocket>(socket);
+    JobPtr job; // Задача "Start execution" цього з'єднання
     try {
         uint8_t type;
-        std::vector<char> value;
+        uint32_t length;
+        TLVReader reader(TLV_READ_CHUNK, MAX_FRAME);
+        TLVFrame frame;
 
-        int matrixSize = 0;
+        int matrixSize = 0; // Останній оголошений клієнтом розмір; стосується лише наступного завантаження
         int numThreads = 0;
-        int** matrix = nullptr;
-        Status status = IDLE;
+        MatrixBuffer matrix;
+        int matrixRows = 0; // Сторона матриці, під яку виділено matrix: обробка і результат беруть розмір звідси
 
         std::cout << "[LOG] Client connected! Thread id: " << std::this_thread::get_id() << std::endl;
 
         // Повідомляємо клієнту про підключення
-        const char* connMsg = "Connected to server";
-        sendTLV(socket, TYPE_COMMAND, connMsg, strlen(connMsg));
+        client->send("Connected to server");
+
+        while (receiveHeader(socket, reader, type, length)) {
+            // Дані матриці приймаються прямо в буфер, на якому потім працює дзеркалення
+            if (type == TYPE_MATRIX_DATA && length == matrixBytes(matrixSize)) {
+                std::cout << "[LOG] Receiving matrix data..." << std::endl;
+                reader.consume(TLV_HEADER_SIZE);
+                matrix = allocateMatrix(matrixSize);
+                matrixRows = matrixSize;
+                if (!receivePayload(socket, reader, reinterpret_cast<char*>(matrix.get()), length)) break;
+                std::cout << "[LOG] Matrix data received" << std::endl;
+                client->send("Matrix data received");
+                continue;
+            }
 
-        while (receiveTLV(socket, type, value)) {
-            switch (type) {
+            // Великі дані приймаються лише в обхід буфера кадрів
+            if (length > MAX_FRAME) {
+                std::cerr << "[ERROR] Frame too large: " << length << " bytes" << std::endl;
+                break;
+            }
+            if (!receiveTLV(socket, reader, frame)) break;
+            switch (frame.type) {
                 case TYPE_MATRIX_SIZE:
-                    memcpy(&matrixSize, value.data(), sizeof(int));
+                    memcpy(&matrixSize, frame.value, std::min<size_t>(frame.length, sizeof(int)));
                     std::cout << "[LOG] Matrix size received: " << matrixSize << std::endl;
-                    sendTLV(socket, TYPE_COMMAND, "Matrix size received", 20);
+                    client->send("Matrix size received");
                     break;
 
                 case TYPE_NUM_THREADS:
-                    memcpy(&numThreads, value.data(), sizeof(int));
+                    memcpy(&numThreads, frame.value, std::min<size_t>(frame.length, sizeof(int)));
                     std::cout << "[LOG] Number of threads received: " << numThreads << std::endl;
-                    sendTLV(socket, TYPE_COMMAND, "Threads received", 16);
+                    client->send("Threads received");
                     break;
 
-                case TYPE_MATRIX_DATA: {
-                    std::cout << "[LOG] Receiving matrix data..." << std::endl;
-                    matrix = new int*[matrixSize];
-                    const int* data = reinterpret_cast<int*>(value.data());
-                    for (int i = 0; i < matrixSize; ++i) {
-                        matrix[i] = new int[matrixSize];
-                        for (int j = 0; j < matrixSize; ++j) {
-                            matrix[i][j] = data[i * matrixSize + j];
-                        }
+                case TYPE_STREAM_BEGIN: {
+                    uint64_t size = 0;
+                    uint32_t threads = 0;
+                    if (frame.length == ROW_CHUNK_PREFIX) decodeRowChunk(frame.value, size, threads);
+                    if (size == 0 || size > uint64_t(INT32_MAX) || (job && !job->finished())) {
+                        std::cerr << "[ERROR] Invalid stream size: " << size << std::endl;
+                        client->send("Execution error");
+                        break;
                     }
-                    std::cout << "[LOG] Matrix data received" << std::endl;
-                    sendTLV(socket, TYPE_COMMAND, "Matrix data received", 20);
-                    break;
+                    std::cout << "[LOG] Stream begin, matrix size " << size << std::endl;
+                    streamExecution(*client, reader, int(size));
+                    client->close();
+                    return;
                 }
 
+                case TYPE_MATRIX_DATA:
+                    std::cerr << "[ERROR] Matrix data size does not match matrix size" << std::endl;
+                    client->send("Execution error");
+                    break;
+
                 case TYPE_COMMAND: {
-                    std::string command(value.data(), value.size());
+                    std::string command(frame.value, frame.length);
+                    uint64_t id = 0;
 
                     if (command == "Start execution") {
                         std::cout << "[LOG] Start execution command received" << std::endl;
-                        const char* ack1 = "Execution begin";
-                        sendTLV(socket, TYPE_COMMAND, ack1, strlen(ack1));
-                        status = PROCESSING;
-
+                        if (!matrix || (job && !job->finished())) {
+                            client->send("Execution error");
+                            break;
+                        }
+                        client->send("Execution begin");
 
-                        // Обробка в окремому потоці
-                        std::thread worker([&]() {
-                            mirrorMatrix(matrix, matrixSize, numThreads);
-                            status = COMPLETED;
+                        // Обробка на спільному пулі; з'єднання тим часом відповідає на інші команди
+                        job = jobManager().start(matrix, matrixRows, numThreads, false, [client](Job&) {
                             std::cout << "[LOG] Matrix processing completed" << std::endl;
+                            client->send("Execution ended. Awaiting result request.");
                         });
 
-                        worker.join();
-                        std::cout << "[LOG] Execution ended. Awaiting result request." << std::endl;
-                        sendTLV(socket, TYPE_COMMAND, "Execution ended. Awaiting result request.", 41);
-
                     } else if (command == "Status") {
-                        std::string statusStr = (status == IDLE ? "idle" :
-                                                status == PROCESSING ? "processing" :
-                                                "completed");
+                        std::string statusStr = job ? job->statusText() : "idle";
                         std::cout << "[LOG] Status requested -> " << statusStr << std::endl;
-                        sendTLV(socket, TYPE_COMMAND, statusStr.c_str(), statusStr.size());
+                        client->send(statusStr);
 
                     } else if (command == "Get result") {
                         std::cout << "[LOG] Client requested result" << std::endl;
 
-                        // Повернення обробленої матриці
-                        std::vector<int> flattened;
-                        for (int i = 0; i < matrixSize; ++i)
-                            for (int j = 0; j < matrixSize; ++j)
-                                flattened.push_back(matrix[i][j]);
-
-                        sendTLV(socket, TYPE_MATRIX_DATA, flattened.data(), flattened.size() * sizeof(int));
-                        std::cout << "[LOG] Result sent to client" << std::endl;
-
-                        // Очищення пам’яті
-                        for (int i = 0; i < matrixSize; ++i) delete[] matrix[i];
-                        delete[] matrix;
+                        // Оброблена матриця відправляється з того самого буфера, без копіювання
+                        const int* result = matrix.get();
+                        int resultSize = matrixRows;
+                        if (job) {
+                            job->wait();
+                            result = job->data();
+                            resultSize = job->size();
+                        }
+                        if (job && job->state() == JobState::Cancelled) {
+                            // Матриця скасованої задачі вже звільнена: замість порожнього результату - явна відповідь
+                            client->send("cancelled");
+                            std::cout << "[LOG] Job was cancelled, no result to send" << std::endl;
+                        } else {
+                            client->send(TYPE_MATRIX_DATA, result, result ? uint32_t(matrixBytes(resultSize)) : 0);
+                            std::cout << "[LOG] Result sent to client" << std::endl;
+                        }
 
                         std::cout << "[LOG] Client task completed. Closing connection." << std::endl;
+                        client->close();
                         return;
 
+                    } else if (command == "Submit job") {
+                        // Матриця переходить до задачі; для наступної задачі клієнт надсилає нову
+                        JobPtr submitted = matrix ? jobManager().start(matrix, matrixRows, numThreads, true) : nullptr;
+                        if (!submitted) {
+                            client->send(matrix ? "Too many jobs" : "Execution error");
+                            break;
+                        }
+                        std::cout << "[LOG] Job " << submitted->id() << " submitted" << std::endl;
+                        client->send("Job " + std::to_string(submitted->id()));
+
+                    } else if (parseJobCommand(command, "Status", id)) {
+                        client->send(jobManager().status(id));
+
+                    } else if (parseJobCommand(command, "Cancel", id)) {
+                        std::cout << "[LOG] Job " << id << " cancel requested" << std::endl;
+                        client->send(jobManager().cancel(id));
+
+                    } else if (parseJobCommand(command, "Get result", id)) {
+                        // Не готова задача відповідає своїм станом, клієнт повторює запит пізніше
+                        JobPtr found = jobManager().take(id);
+                        if (!found) {
+                            client->send(jobManager().status(id));
+                        } else {
+                            client->send(TYPE_MATRIX_DATA, found->data(), uint32_t(matrixBytes(found->size())));
+                            std::cout << "[LOG] Job " << id << " result sent" << std::endl;
+                        }
+
                     } else {
                         std::cout << "[LOG] Status: " << command << std::endl;
-                        sendTLV(socket, TYPE_COMMAND, command.c_str(), command.size());
+                        client->send(command);
                     }
                     break;
                 }
 
                 default:
                     std::cerr << "[ERROR] Unknown TLV type received" << std::endl;
-                    sendTLV(socket, TYPE_COMMAND, "Unknown TLV type", 16);
+                    client->send("Unknown TLV type");
                     break;
             }
         }
     } catch (const std::bad_alloc&) {
         std::cerr << "[FATAL] Memory allocation failed (std::bad_alloc)" << std::endl;
-        sendTLV(socket, TYPE_COMMAND, "Memory error", 12);
+        client->send("Memory error");
     } catch (const std::exception& ex) {
         std::cerr << "[ERROR] Exception: " << ex.what() << std::endl;
-        sendTLV(socket, TYPE_COMMAND, "Execution error", 15);
+        client->send("Execution error");
     }
 
-    closesocket(socket);
+    // Результат незабраної задачі з'єднання вже нікому не потрібен
+    if (job) job->cancel();
+    client->close();
 }
 
 
@@ -219,3 +763,631 @@ int main() {
     WSACleanup();
     return 0;
 }
+
+#else
+
+// Linux: один потік циклу подій на epoll обслуговує всі з'єднання (неблокуючі сокети,
+// розбір TLV як скінченний автомат на кожне з'єднання), а дзеркалення виконує фіксований
+// пул обчислювальних потоків. Тисячі клієнтів не означають тисячі потоків
+
+const int PORT = 7777;
+const int COMPUTE_WORKERS = 0; // Потоків обчислень; 0 - за кількістю ядер
+const bool VERBOSE = false; // Журнал кожного повідомлення; на тисячах клієнтів суттєво гальмує цикл подій
+
+std::atomic<bool> running(true);
+
+// Частина черги відправлення: власні байти (короткі кадри склеюються в одну частину)
+// або посилання на рядки матриці, що відправляються без копіювання
+struct OutChunk {
+    std::vector<char> bytes;
+    const char* ref = nullptr;
+    size_t refSize = 0;
+    std::shared_ptr<void> owner; // Тримає буфер ref до кінця відправлення
+    size_t sent = 0;
+
+    const char* data() const { return ref ? ref : bytes.data(); }
+    size_t size() const { return ref ? refSize : bytes.size(); }
+};
+
+// Куди recv пише дані великого кадру в обхід буфера кадрів
+enum class Payload {
+    None,
+    Matrix, // TYPE_MATRIX_DATA цілком
+    Chunk   // рядки TYPE_MATRIX_CHUNK
+};
+
+struct Connection {
+    int fd;
+    TLVReader in{TLV_READ_CHUNK, MAX_FRAME};
+    std::deque<OutChunk> out;
+    bool watchingWrite = false; // Підписка на EPOLLOUT лише поки є що дописати
+    bool closeAfterWrite = false;
+    bool closed = false;
+    bool resultRequested = false; // "Get result" прийшов під час обробки; розбір стоїть до її завершення
+
+    int matrixSize = 0; // Останній оголошений клієнтом розмір; стосується лише наступного завантаження
+    int numThreads = 0;
+    MatrixBuffer matrix;
+    int matrixRows = 0; // Сторона матриці, під яку виділено matrix: обробка і результат беруть розмір звідси
+    Status status = IDLE;
+    JobPtr job; // Задача "Start execution"; після завершення матриця повертається в matrix
+
+    Payload payload = Payload::None;
+    char* payloadTarget = nullptr;
+    size_t payloadReceived = 0;
+    size_t payloadExpected = 0;
+    uint64_t chunkFirstRow = 0;
+    uint32_t chunkRows = 0;
+
+    std::shared_ptr<StreamingMirror> stream;
+    int tilesSent = 0;
+
+    explicit Connection(int fd) : fd(fd) {}
+};
+
+using ConnectionPtr = std::shared_ptr<Connection>;
+
+// Обробка завершилася (tile = -1) або в потоковому режимі готова смуга рядків tile
+struct Completion {
+    ConnectionPtr conn;
+    int tile;
+};
+
+// Потоки пулу додають сюди, цикл подій забирає, прокинувшись від eventfd
+class CompletionQueue {
+public:
+    explicit CompletionQueue(int eventFd) : eventFd(eventFd) {}
+
+    void push(ConnectionPtr conn, int tile = -1) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done.push_back({std::move(conn), tile});
+        }
+        uint64_t one = 1;
+        ssize_t written = write(eventFd, &one, sizeof(one));
+        (void)written;
+    }
+
+    std::vector<Completion> take() {
+        uint64_t counter;
+        while (read(eventFd, &counter, sizeof(counter)) > 0) {}
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<Completion> result;
+        result.swap(done);
+        return result;
+    }
+
+private:
+    int eventFd;
+    std::mutex mtx;
+    std::vector<Completion> done;
+};
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+class EventLoop {
+public:
+    EventLoop(int listenFd, int workers)
+        : listenFd(listenFd), epollFd(epoll_create1(0)), eventFd(eventfd(0, EFD_NONBLOCK)),
+          completions(eventFd), pool(workers), jobs(pool) {
+        watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(eventFd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    ~EventLoop() {
+        for (auto& entry : connections) close(entry.first);
+        close(epollFd);
+        close(eventFd);
+    }
+
+    void run() {
+        std::vector<epoll_event> events(256);
+        while (running) {
+            int count = epoll_wait(epollFd, events.data(), int(events.size()), -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "[FATAL] epoll_wait: " << strerror(errno) << std::endl;
+                return;
+            }
+            for (int e = 0; e < count; ++e) {
+                int fd = events[e].data.fd;
+                if (fd == listenFd) {
+                    acceptClients();
+                } else if (fd == eventFd) {
+                    for (Completion& done : completions.take()) {
+                        if (done.tile < 0) finishExecution(done.conn);
+                        else sendStreamTile(done.conn, done.tile);
+                    }
+                } else {
+                    auto it = connections.find(fd);
+                    if (it == connections.end()) continue;
+                    ConnectionPtr conn = it->second;
+                    if (events[e].events & (EPOLLERR | EPOLLHUP)) {
+                        closeClient(conn);
+                        continue;
+                    }
+                    if (events[e].events & EPOLLOUT) flush(conn);
+                    if (!conn->closed && (events[e].events & EPOLLIN)) readClient(conn);
+                }
+            }
+        }
+    }
+
+private:
+    void watch(int fd, uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, op, fd, &ev);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                // EAGAIN - черга прийому вичерпана; EMFILE - наступна спроба буде на наступній події
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    std::cerr << "[ERROR] accept: " << strerror(errno) << std::endl;
+                }
+                return;
+            }
+            // Відповіді - короткі повідомлення, алгоритм Нейгла лише додав би затримку
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            auto conn = std::make_shared<Connection>(fd);
+            connections[fd] = conn;
+            watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+            if (VERBOSE) std::cout << "[LOG] Client connected! fd: " << fd << std::endl;
+
+            // Повідомляємо клієнту про підключення
+            sendMessage(conn, "Connected to server");
+            flush(conn);
+        }
+    }
+
+    void closeClient(const ConnectionPtr& conn) {
+        if (conn->closed) return;
+        conn->closed = true;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        close(conn->fd);
+        connections.erase(conn->fd);
+        // Задача з'єднання вже нікому не потрібна: її частини зупиняться на найближчому кроці
+        if (conn->job) conn->job->cancel();
+        conn->in = TLVReader(TLV_READ_CHUNK, MAX_FRAME);
+        conn->out.clear();
+        conn->stream.reset();
+    }
+
+    // Кадри розбираються після кожного recv: щойно почалися дані матриці або блоку рядків,
+    // наступні recv пишуть прямо в буфер матриці, а не в буфер кадрів
+    void readClient(const ConnectionPtr& conn) {
+        while (!conn->closed) {
+            ssize_t received;
+            if (conn->payload != Payload::None) {
+                char* target = conn->payloadTarget + conn->payloadReceived;
+                received = recv(conn->fd, target, conn->payloadExpected - conn->payloadReceived, 0);
+                if (received > 0) {
+                    conn->payloadReceived += received;
+                    if (conn->payloadReceived == conn->payloadExpected) {
+                        payloadReceived(conn);
+                        processFrames(conn);
+                    }
+                    continue;
+                }
+            } else {
+                char* target = conn->in.writePtr();
+                received = recv(conn->fd, target, conn->in.writable(), 0);
+                if (received > 0) {
+                    conn->in.commit(received);
+                    processFrames(conn);
+                    continue;
+                }
+            }
+            if (received < 0 && errno == EINTR) continue;
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            // 0 - клієнт закрив з'єднання, інакше помилка
+            closeClient(conn);
+            return;
+        }
+    }
+
+    // Розбирає всі повні кадри з буфера; неповний заголовок або дані чекають наступного recv.
+    // Нестача пам'яті (або бюджету матриць) закриває лише це з'єднання, а не весь сервер
+    void processFrames(const ConnectionPtr& conn) {
+        try {
+            parseFrames(conn);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "[ERROR] Memory allocation failed (std::bad_alloc)" << std::endl;
+            sendMessage(conn, "Memory error");
+            conn->closeAfterWrite = true;
+        }
+        if (!conn->closed) flush(conn);
+    }
+
+    void parseFrames(const ConnectionPtr& conn) {
+        uint8_t type;
+        uint32_t length;
+        while (!conn->closed && !conn->resultRequested && !conn->closeAfterWrite && conn->in.peekHeader(type, length)) {
+            if (type == TYPE_MATRIX_DATA && conn->status != PROCESSING && length == matrixBytes(conn->matrixSize)) {
+                conn->in.consume(TLV_HEADER_SIZE);
+                conn->matrix = allocateMatrix(conn->matrixSize);
+                conn->matrixRows = conn->matrixSize;
+                startPayload(conn, Payload::Matrix, reinterpret_cast<char*>(conn->matrix.get()), length);
+                if (conn->payload != Payload::None) break;
+                continue;
+            }
+            if (type == TYPE_MATRIX_CHUNK) {
+                if (conn->in.buffered() < TLV_HEADER_SIZE + ROW_CHUNK_PREFIX) break;
+                if (!startChunk(conn, length)) return;
+                if (conn->payload != Payload::None) break;
+                continue;
+            }
+            // Великі дані приймаються лише в обхід буфера кадрів
+            if (length > MAX_FRAME) {
+                std::cerr << "[ERROR] Frame too large: " << length << " bytes" << std::endl;
+                closeClient(conn);
+                return;
+            }
+            TLVFrame frame;
+            if (!conn->in.next(frame)) break;
+            handleFrame(conn, frame.type, frame.value, frame.length);
+        }
+    }
+
+    void handleFrame(const ConnectionPtr& conn, uint8_t type, const char* data, uint32_t length) {
+        switch (type) {
+            case TYPE_MATRIX_SIZE:
+            case TYPE_NUM_THREADS: {
+                int value = 0;
+                memcpy(&value, data, std::min<size_t>(length, sizeof(value)));
+                if (type == TYPE_MATRIX_SIZE) {
+                    conn->matrixSize = value;
+                    if (VERBOSE) std::cout << "[LOG] Matrix size received: " << value << std::endl;
+                    sendMessage(conn, "Matrix size received");
+                } else {
+                    conn->numThreads = value;
+                    if (VERBOSE) std::cout << "[LOG] Number of threads received: " << value << std::endl;
+                    sendMessage(conn, "Threads received");
+                }
+                break;
+            }
+
+            case TYPE_MATRIX_DATA:
+                // Кадри правильного розміру сюди не потрапляють - їх приймає startMatrixReceive
+                std::cerr << "[ERROR] Matrix data rejected: " << length << " bytes, expected "
+                          << matrixBytes(conn->matrixSize) << std::endl;
+                sendMessage(conn, "Execution error");
+                break;
+
+            case TYPE_COMMAND:
+                handleCommand(conn, std::string(data, length));
+                break;
+
+            case TYPE_STREAM_BEGIN:
+                startStream(conn, data, length);
+                break;
+
+            default:
+                std::cerr << "[ERROR] Unknown TLV type received" << std::endl;
+                sendMessage(conn, "Unknown TLV type");
+                break;
+        }
+    }
+
+    // Дані оминають буфер кадрів: байти, що вже прийшли разом із заголовком, копіюються
+    // (не більше одного TLV_READ_CHUNK), решту recv пише прямо в target
+    void startPayload(const ConnectionPtr& conn, Payload payload, char* target, size_t length) {
+        size_t buffered = std::min(length, conn->in.buffered());
+        memcpy(target, conn->in.data(), buffered);
+        conn->in.consume(buffered);
+        conn->payload = payload;
+        conn->payloadTarget = target;
+        conn->payloadReceived = buffered;
+        conn->payloadExpected = length;
+        if (buffered == length) payloadReceived(conn);
+    }
+
+    void payloadReceived(const ConnectionPtr& conn) {
+        Payload payload = conn->payload;
+        conn->payload = Payload::None;
+        if (payload == Payload::Matrix) {
+            conn->status = IDLE;
+            if (VERBOSE) std::cout << "[LOG] Matrix data received" << std::endl;
+            sendMessage(conn, "Matrix data received");
+        } else {
+            conn->stream->addRows(conn->chunkFirstRow, conn->chunkRows);
+            if (VERBOSE && conn->stream->uploaded()) std::cout << "[LOG] Stream upload completed" << std::endl;
+        }
+    }
+
+    // Потоковий режим: матриця до 2^31 рядків приходить блоками TYPE_MATRIX_CHUNK у довільному порядку,
+    // готові смуги результату йдуть назад блоками TYPE_RESULT_CHUNK, потім "Stream completed".
+    // Рядки обробляє спільний пул, тож кількість потоків від клієнта тут лише для сумісності
+    void startStream(const ConnectionPtr& conn, const char* data, uint32_t length) {
+        uint64_t size = 0;
+        uint32_t threads = 0;
+        if (length == ROW_CHUNK_PREFIX) decodeRowChunk(data, size, threads);
+        if (conn->status == PROCESSING || size == 0 || size > uint64_t(INT32_MAX)) {
+            std::cerr << "[ERROR] Invalid stream size: " << size << std::endl;
+            sendMessage(conn, "Execution error");
+            return;
+        }
+        conn->matrixSize = int(size);
+        conn->numThreads = int(threads);
+        conn->matrix.reset();
+        conn->matrixRows = 0;
+        conn->tilesSent = 0;
+        std::weak_ptr<Connection> weak = conn;
+        conn->stream = std::make_shared<StreamingMirror>(
+            int(size), [this](std::function<void()> job) { pool.submit(std::move(job)); },
+            [this, weak](int tile) {
+                if (ConnectionPtr owner = weak.lock()) completions.push(owner, tile);
+            });
+        conn->status = PROCESSING;
+        if (VERBOSE) std::cout << "[LOG] Stream begin, matrix size " << size << std::endl;
+        sendMessage(conn, "Stream begin");
+    }
+
+    // Заголовок і префікс блоку вже в буфері. Неправильний блок не пропустити без прийому
+    // всіх його даних, тож з'єднання закривається
+    bool startChunk(const ConnectionPtr& conn, uint32_t length) {
+        uint64_t firstRow;
+        uint32_t rowCount;
+        decodeRowChunk(conn->in.data() + TLV_HEADER_SIZE, firstRow, rowCount);
+        StreamingMirror* stream = conn->stream.get();
+        uint64_t rowBytes = stream ? uint64_t(stream->matrixSize()) * sizeof(int) : 0;
+        if (!stream || length != ROW_CHUNK_PREFIX + rowCount * rowBytes || !stream->canAccept(firstRow, rowCount)) {
+            std::cerr << "[ERROR] Invalid matrix chunk: rows " << firstRow << " + " << rowCount << std::endl;
+            sendMessage(conn, "Execution error");
+            conn->closeAfterWrite = true;
+            flush(conn);
+            return false;
+        }
+        conn->in.consume(TLV_HEADER_SIZE + ROW_CHUNK_PREFIX);
+        conn->chunkFirstRow = firstRow;
+        conn->chunkRows = rowCount;
+        startPayload(conn, Payload::Chunk, reinterpret_cast<char*>(stream->rows(firstRow)), rowCount * rowBytes);
+        return true;
+    }
+
+    // Смуга tile більше не змінюється: її рядки відправляються прямо з буфера матриці
+    void sendStreamTile(const ConnectionPtr& conn, int tile) {
+        if (conn->closed || !conn->stream) return;
+        StreamingMirror& stream = *conn->stream;
+        uint32_t rowCount = uint32_t(stream.tileRows(tile));
+        size_t bytes = size_t(rowCount) * stream.matrixSize() * sizeof(int);
+        char prefix[ROW_CHUNK_PREFIX];
+        encodeRowChunk(prefix, uint64_t(stream.tileFirstRow(tile)), rowCount);
+        queueTLV(conn, TYPE_RESULT_CHUNK, prefix, uint32_t(ROW_CHUNK_PREFIX + bytes), ROW_CHUNK_PREFIX);
+        queueRef(conn, reinterpret_cast<const char*>(stream.rows(stream.tileFirstRow(tile))), bytes);
+        if (++conn->tilesSent == stream.tileCount()) {
+            conn->status = COMPLETED;
+            if (VERBOSE) std::cout << "[LOG] Stream completed" << std::endl;
+            sendMessage(conn, "Stream completed");
+            conn->closeAfterWrite = true;
+        }
+        flush(conn);
+    }
+
+    void handleCommand(const ConnectionPtr& conn, const std::string& command) {
+        uint64_t id = 0;
+        if (command == "Start execution") {
+            if (VERBOSE) std::cout << "[LOG] Start execution command received" << std::endl;
+            if (conn->status == PROCESSING || !conn->matrix) {
+                sendMessage(conn, "Execution error");
+                return;
+            }
+            sendMessage(conn, "Execution begin");
+            startExecution(conn);
+        } else if (command == "Status") {
+            std::string statusStr = (conn->job ? conn->job->statusText() :
+                                    conn->status == IDLE ? "idle" :
+                                    conn->status == PROCESSING ? "processing" :
+                                    "completed");
+            if (VERBOSE) std::cout << "[LOG] Status requested -> " << statusStr << std::endl;
+            sendMessage(conn, statusStr);
+        } else if (command == "Get result") {
+            if (VERBOSE) std::cout << "[LOG] Client requested result" << std::endl;
+            if (conn->stream) {
+                // Потоковий результат іде сам; чекати на нього тут означало б зупинити прийом блоків
+                sendMessage(conn, "Execution error");
+                return;
+            }
+            if (conn->status == PROCESSING) {
+                conn->resultRequested = true;
+                return;
+            }
+            sendResult(conn);
+        } else if (command == "Submit job") {
+            // Матриця переходить до задачі; для наступної задачі клієнт надсилає нову
+            JobPtr job = conn->matrix && conn->status != PROCESSING
+                ? jobs.start(conn->matrix, conn->matrixRows, conn->numThreads, true) : nullptr;
+            if (!job) {
+                sendMessage(conn, conn->matrix && conn->status != PROCESSING ? "Too many jobs" : "Execution error");
+                return;
+            }
+            if (VERBOSE) std::cout << "[LOG] Job " << job->id() << " submitted" << std::endl;
+            sendMessage(conn, "Job " + std::to_string(job->id()));
+        } else if (parseJobCommand(command, "Status", id)) {
+            sendMessage(conn, jobs.status(id));
+        } else if (parseJobCommand(command, "Cancel", id)) {
+            sendMessage(conn, jobs.cancel(id));
+        } else if (parseJobCommand(command, "Get result", id)) {
+            // Не готова задача відповідає своїм станом, клієнт повторює запит пізніше.
+            // З'єднання після результату задачі не закривається
+            JobPtr job = jobs.take(id);
+            if (!job) {
+                sendMessage(conn, jobs.status(id));
+                return;
+            }
+            uint32_t length = uint32_t(matrixBytes(job->size()));
+            queueTLV(conn, TYPE_MATRIX_DATA, nullptr, length, 0);
+            queueRef(conn, reinterpret_cast<const char*>(job->data()), length, job);
+        } else {
+            if (VERBOSE) std::cout << "[LOG] Status: " << command << std::endl;
+            sendMessage(conn, command);
+        }
+    }
+
+    // Матриця на час обробки переходить до задачі; її завершення повідомляє цикл подій
+    void startExecution(const ConnectionPtr& conn) {
+        std::weak_ptr<Connection> weak = conn;
+        conn->job = jobs.start(conn->matrix, conn->matrixRows, conn->numThreads, false, [this, weak](Job&) {
+            if (ConnectionPtr owner = weak.lock()) completions.push(owner);
+        });
+        conn->status = PROCESSING;
+    }
+
+    void finishExecution(const ConnectionPtr& conn) {
+        conn->status = COMPLETED;
+        if (conn->job) {
+            conn->matrix = conn->job->takeMatrix();
+            conn->job.reset();
+        }
+        if (conn->closed) return;
+        if (VERBOSE) std::cout << "[LOG] Execution ended. Awaiting result request." << std::endl;
+        sendMessage(conn, "Execution ended. Awaiting result request.");
+        if (conn->resultRequested) {
+            conn->resultRequested = false;
+            sendResult(conn);
+        }
+        // Кадри, що прийшли під час обробки, чекали в буфері
+        processFrames(conn);
+    }
+
+    // У чергу йде лише заголовок, а дані flush відправляє прямо з буфера матриці.
+    // Після відправлення з'єднання закривається
+    void sendResult(const ConnectionPtr& conn) {
+        if (conn->closed) return;
+        conn->closeAfterWrite = true;
+        uint32_t length = conn->matrix ? uint32_t(matrixBytes(conn->matrixRows)) : 0;
+        queueTLV(conn, TYPE_MATRIX_DATA, nullptr, length, 0);
+        queueRef(conn, reinterpret_cast<const char*>(conn->matrix.get()), length);
+        if (VERBOSE) std::cout << "[LOG] Result sent to client" << std::endl;
+    }
+
+    void sendMessage(const ConnectionPtr& conn, const std::string& message) {
+        queueTLV(conn, TYPE_COMMAND, message.data(), uint32_t(message.size()));
+    }
+
+    // Кадр лише дописується в чергу з'єднання: відповіді на всі кадри, розібрані з одного recv,
+    // відправляються одним викликом flush у кінці processFrames.
+    // Якщо copied < length, решту даних кадру викликач додає через queueRef
+    void queueTLV(const ConnectionPtr& conn, TLVType type, const void* data, uint32_t length, size_t copied) {
+        if (conn->closed) return;
+        if (conn->out.empty() || conn->out.back().ref) conn->out.emplace_back();
+        std::vector<char>& bytes = conn->out.back().bytes;
+        appendTLVHeader(bytes, type, length);
+        bytes.insert(bytes.end(), static_cast<const char*>(data), static_cast<const char*>(data) + copied);
+    }
+
+    void queueTLV(const ConnectionPtr& conn, TLVType type, const void* data, uint32_t length) {
+        queueTLV(conn, type, data, length, length);
+    }
+
+    void queueRef(const ConnectionPtr& conn, const char* data, size_t size, std::shared_ptr<void> owner = nullptr) {
+        if (conn->closed || size == 0) return;
+        OutChunk chunk;
+        chunk.ref = data;
+        chunk.refSize = size;
+        chunk.owner = std::move(owner);
+        conn->out.push_back(std::move(chunk));
+    }
+
+    // Уся черга (до IOV_PARTS частин за раз) відправляється одним sendmsg
+    void flush(const ConnectionPtr& conn) {
+        const size_t IOV_PARTS = 16;
+        while (!conn->out.empty()) {
+            iovec parts[IOV_PARTS];
+            size_t count = 0;
+            for (auto it = conn->out.begin(); it != conn->out.end() && count < IOV_PARTS; ++it, ++count) {
+                parts[count].iov_base = const_cast<char*>(it->data()) + it->sent;
+                parts[count].iov_len = it->size() - it->sent;
+            }
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = count;
+            ssize_t sent = sendmsg(conn->fd, &message, MSG_NOSIGNAL);
+            if (sent > 0) {
+                size_t left = size_t(sent);
+                while (left > 0) {
+                    OutChunk& front = conn->out.front();
+                    size_t step = std::min(left, front.size() - front.sent);
+                    front.sent += step;
+                    left -= step;
+                    if (front.sent == front.size()) conn->out.pop_front();
+                }
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!conn->watchingWrite) {
+                    conn->watchingWrite = true;
+                    watch(conn->fd, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);
+                }
+                return;
+            }
+            closeClient(conn);
+            return;
+        }
+        if (conn->watchingWrite) {
+            conn->watchingWrite = false;
+            watch(conn->fd, EPOLLIN, EPOLL_CTL_MOD);
+        }
+        if (conn->closeAfterWrite) {
+            if (VERBOSE) std::cout << "[LOG] Client task completed. Closing connection." << std::endl;
+            closeClient(conn);
+        }
+    }
+
+    int listenFd;
+    int epollFd;
+    int eventFd;
+    CompletionQueue completions;
+    ComputePool pool;
+    JobManager jobs;
+    std::unordered_map<int, ConnectionPtr> connections;
+};
+
+int main() {
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, [](int) { running = false; });
+    signal(SIGTERM, [](int) { running = false; });
+
+    // Кожен клієнт - дескриптор; типового ліміту 1024 на тисячі з'єднань не вистачить
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(PORT);
+    serverAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0 || listen(serverSocket, SOMAXCONN) < 0 ||
+        !setNonBlocking(serverSocket)) {
+        std::cerr << "[FATAL] Cannot listen on port " << PORT << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    int workers = COMPUTE_WORKERS > 0 ? COMPUTE_WORKERS : int(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "Server is running on port " << PORT << " (epoll, " << workers << " compute workers)\n";
+    {
+        EventLoop loop(serverSocket, workers);
+        loop.run();
+    }
+
+    close(serverSocket);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "../common/affinity.h"
+
+using namespace std;
+using namespace chrono;
+
+// Пропускна здатність пам'яті між вузлами NUMA: буфер розміщується на вузлі пам'яті першим дотиком
+// потоків, закріплених за його ядрами, а потім читається і записується потоками, закріпленими
+// за ядрами вузла обчислень. Діагональ таблиці - локальний доступ, решта - віддалений.
+// На машині з одним вузлом міряється лише локальна пропускна здатність.
+// Використання: numa_bench [--size-mb=512] [--threads=N] [--repeat=5]
+
+struct Measurement {
+    double readGBs;
+    double writeGBs;
+};
+
+// Запускає func(index, begin, end) на потоках, закріплених за cpus; кожен потік отримує свою частину
+// [0, count). Повертає час від спільного старту до завершення останнього потоку
+template <typename Func>
+double runOnCpus(const vector<int>& cpus, size_t count, Func func) {
+    atomic<int> ready(0);
+    atomic<bool> go(false);
+    vector<thread> threads;
+    for (size_t t = 0; t < cpus.size(); t++) {
+        threads.emplace_back([&, t] {
+            pinCurrentThreadToCpu(cpus[t]);
+            size_t begin = count * t / cpus.size();
+            size_t end = count * (t + 1) / cpus.size();
+            ready.fetch_add(1);
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            func(t, begin, end);
+        });
+    }
+    while (ready.load() < int(cpus.size())) this_thread::yield();
+    auto startTime = steady_clock::now();
+    go.store(true, memory_order_release);
+    for (auto& t : threads) t.join();
+    return duration<double>(steady_clock::now() - startTime).count();
+}
+
+vector<int> firstCpus(const vector<int>& cpus, int limit) {
+    if (limit <= 0 || limit >= int(cpus.size())) return cpus;
+    return vector<int>(cpus.begin(), cpus.begin() + limit);
+}
+
+Measurement measure(const CpuTopology& topology, int cpuNode, int memNode, size_t words, int threadsPerNode, int repeat) {
+    // Буфер без обнулення; сторінки торкаються потоки вузла пам'яті
+    FirstTouchVector<uint64_t> buffer(words);
+    runOnCpus(firstCpus(topology.nodes[memNode], threadsPerNode), words, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) buffer[i] = i;
+    });
+
+    vector<int> cpus = firstCpus(topology.nodes[cpuNode], threadsPerNode);
+    vector<uint64_t> sums(cpus.size());
+    double bestRead = 1e30, bestWrite = 1e30;
+    for (int r = 0; r < repeat; r++) {
+        bestRead = min(bestRead, runOnCpus(cpus, words, [&](size_t t, size_t begin, size_t end) {
+            uint64_t sum = 0;
+            for (size_t i = begin; i < end; i++) sum += buffer[i];
+            sums[t] += sum;
+        }));
+        bestWrite = min(bestWrite, runOnCpus(cpus, words, [&](size_t, size_t begin, size_t end) {
+            fill(buffer.begin() + begin, buffer.begin() + end, uint64_t(r));
+        }));
+    }
+
+    // Запис у volatile не дає компілятору викинути читання
+    static volatile uint64_t sink;
+    for (uint64_t sum : sums) sink = sink + sum;
+
+    double bytes = double(words) * sizeof(uint64_t);
+    return {bytes / bestRead / 1e9, bytes / bestWrite / 1e9};
+}
+
+int main(int argc, char* argv[]) {
+    long long sizeMb = 512;
+    int threadsPerNode = 0;
+    int repeat = 5;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.substr(arg.find('=') + 1);
+        if (arg.rfind("--size-mb=", 0) == 0) sizeMb = max(1LL, atoll(value.c_str()));
+        else if (arg.rfind("--threads=", 0) == 0) threadsPerNode = max(0, atoi(value.c_str()));
+        else if (arg.rfind("--repeat=", 0) == 0) repeat = max(1, atoi(value.c_str()));
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+
+    const CpuTopology& topology = cpuTopology();
+    cout << "NUMA nodes: " << topology.nodeCount() << endl;
+    for (int node = 0; node < topology.nodeCount(); node++) {
+        cout << "  node " << node << ": " << topology.nodes[node].size() << " CPUs" << endl;
+    }
+    if (topology.nodeCount() == 1) {
+        cout << "Single node: remote bandwidth cannot be measured, reporting local bandwidth only" << endl;
+    }
+
+    size_t words = size_t(sizeMb) * 1024 * 1024 / sizeof(uint64_t);
+    cout << "Buffer: " << sizeMb << " MB, best of " << repeat << endl;
+    cout << "cpu_node  mem_node  placement  read_GB/s  write_GB/s" << endl;
+    cout << fixed << setprecision(2);
+    for (int cpuNode = 0; cpuNode < topology.nodeCount(); cpuNode++) {
+        for (int memNode = 0; memNode < topology.nodeCount(); memNode++) {
+            Measurement m = measure(topology, cpuNode, memNode, words, threadsPerNode, repeat);
+            cout << setw(8) << cpuNode << setw(10) << memNode << setw(11) << (cpuNode == memNode ? "local" : "remote")
+                 << setw(11) << m.readGBs << setw(12) << m.writeGBs << endl;
+        }
+    }
+    return 0;
+}
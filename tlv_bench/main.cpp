@@ -0,0 +1,180 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "../common/tlv_framing.h"
+
+using namespace std;
+using namespace chrono;
+
+// Повідомлень за секунду через TCP на loopback для двох способів обміну кадрами TLV:
+//   legacy - три send на кадр (тип, довжина, дані) і два recv на заголовок, як було в lab4;
+//   framed - один векторний запис на кадр і прийом через буфер з'єднання (common/tlv_framing.h).
+// Схеми: pingpong - клієнт чекає відлуння кожного кадру; stream - кадри йдуть потоком,
+// відповідь одна в кінці. Алгоритм Нейгла увімкнений, як у lab4, якщо не задано --nodelay;
+// тоді legacy pingpong впирається в затримку підтверджень, тож кожен прогін обмежений у часі.
+// Кінець прогону - кадр нульової довжини, на який приходить відповідь "done".
+// Використання: tlv_bench [--messages=100000] [--payload=16] [--seconds=3] [--nodelay]
+
+const uint8_t TYPE_COMMAND = 4;
+
+struct Settings {
+    long long messages = 100000;
+    int payload = 16;
+    double seconds = 3;
+    bool noDelay = false;
+};
+
+// Старий обмін, лише для порівняння
+void legacySend(int socket, uint8_t type, const void* data, uint32_t length) {
+    send(socket, reinterpret_cast<const char*>(&type), sizeof(type), MSG_NOSIGNAL);
+    send(socket, reinterpret_cast<const char*>(&length), sizeof(length), MSG_NOSIGNAL);
+    send(socket, reinterpret_cast<const char*>(data), length, MSG_NOSIGNAL);
+}
+
+bool legacyReceive(int socket, uint8_t& type, vector<char>& value) {
+    uint32_t length = 0;
+    if (recv(socket, reinterpret_cast<char*>(&type), sizeof(type), 0) <= 0) return false;
+    if (recv(socket, reinterpret_cast<char*>(&length), sizeof(length), 0) <= 0) return false;
+    value.resize(length);
+    size_t received = 0;
+    while (received < length) {
+        ssize_t chunk = recv(socket, value.data() + received, length - received, 0);
+        if (chunk <= 0) return false;
+        received += chunk;
+    }
+    return true;
+}
+
+// Однаковий інтерфейс для обох способів: кожне з'єднання має власний буфер прийому
+struct Channel {
+    int socket;
+    bool framed;
+    TLVReader reader;
+    vector<char> value;
+    uint32_t length = 0; // Довжина останнього прийнятого кадру
+
+    Channel(int socket, bool framed) : socket(socket), framed(framed) {}
+
+    bool send(const void* data, uint32_t length) {
+        if (framed) return sendTLV(socket, TYPE_COMMAND, data, length);
+        legacySend(socket, TYPE_COMMAND, data, length);
+        return true;
+    }
+
+    bool receive() {
+        if (framed) {
+            TLVFrame frame;
+            if (!receiveTLV(socket, reader, frame)) return false;
+            length = frame.length;
+            return true;
+        }
+        uint8_t type;
+        if (!legacyReceive(socket, type, value)) return false;
+        length = uint32_t(value.size());
+        return true;
+    }
+};
+
+// Пара з'єднаних TCP-сокетів на 127.0.0.1
+bool connectPair(int& client, int& server, bool noDelay) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0 ||
+        getsockname(listener, (sockaddr*)&addr, &size) < 0) {
+        close(listener);
+        return false;
+    }
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    bool ok = connect(client, (sockaddr*)&addr, sizeof(addr)) == 0;
+    server = ok ? accept(listener, nullptr, nullptr) : -1;
+    close(listener);
+    if (server < 0) return false;
+    int flag = noDelay ? 1 : 0;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    return true;
+}
+
+// Повідомлень за секунду; -1 при помилці з'єднання
+double run(const Settings& settings, bool framed, bool pingPong) {
+    int clientSocket, serverSocket;
+    if (!connectPair(clientSocket, serverSocket, settings.noDelay)) return -1;
+    // Порожні дані зарезервовані під кінець прогону
+    vector<char> payload(max(1, settings.payload), 'x');
+
+    thread echo([&] {
+        Channel server(serverSocket, framed);
+        while (server.receive()) {
+            if (server.length == 0) {
+                server.send("done", 4);
+                return;
+            }
+            if (pingPong && !server.send(payload.data(), uint32_t(payload.size()))) return;
+        }
+    });
+
+    Channel client(clientSocket, framed);
+    bool ok = true;
+    long long messages = 0;
+    auto startTime = steady_clock::now();
+    auto deadline = startTime + duration<double>(settings.seconds);
+    while (ok && messages < settings.messages && steady_clock::now() < deadline) {
+        ok = client.send(payload.data(), uint32_t(payload.size()));
+        if (ok && pingPong) ok = client.receive();
+        messages++;
+    }
+    ok = ok && client.send(nullptr, 0) && client.receive();
+    double seconds = duration<double>(steady_clock::now() - startTime).count();
+
+    shutdown(clientSocket, SHUT_RDWR);
+    echo.join();
+    close(clientSocket);
+    close(serverSocket);
+    return ok ? messages / seconds : -1;
+}
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.substr(arg.find('=') + 1);
+        if (arg.rfind("--messages=", 0) == 0) settings.messages = max(1LL, atoll(value.c_str()));
+        else if (arg.rfind("--payload=", 0) == 0) settings.payload = max(1, atoi(value.c_str()));
+        else if (arg.rfind("--seconds=", 0) == 0) settings.seconds = max(0.1, atof(value.c_str()));
+        else if (arg == "--nodelay") settings.noDelay = true;
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    cout << "Messages: up to " << settings.messages << " or " << settings.seconds << " s per run, payload: " << settings.payload << " bytes, TCP_NODELAY: "
+         << (settings.noDelay ? "on" : "off") << endl;
+    cout << "pattern   framing   messages/s" << endl;
+    cout << fixed << setprecision(0);
+    for (bool pingPong : {true, false}) {
+        for (bool framed : {false, true}) {
+            double rate = run(settings, framed, pingPong);
+            cout << left << setw(10) << (pingPong ? "pingpong" : "stream") << setw(10) << (framed ? "framed" : "legacy")
+                 << right << setw(10) << rate << endl;
+        }
+    }
+    return 0;
+}